@@ -0,0 +1,152 @@
+#pragma once
+
+#include "FormalPowerSeries.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// Computes the product of polynomials a and b, of `a_size` and `b_size`
+/// coefficients, without holding either operand or the product in memory.
+/// `read_a(offset, count)` and `read_b(offset, count)` return the `count`
+/// coefficients of their operand starting at `offset` as a `std::vector<T>`,
+/// and the product is passed to `sink`, a callable taking a
+/// `const std::vector<T> &` and returning whether it was accepted, in
+/// consecutive blocks of `block_size` coefficients (the last possibly
+/// shorter). Operand blocks are multiplied pairwise with `Convolution` and
+/// overlap-added, grouped by the output block they start in, so that each
+/// output block is final, and is emitted, once its group is done. Working
+/// memory is O(B) for block size B, and no call to `Convolution` sees an
+/// operand longer than B, bounding its transform length (for example, below
+/// ACL's 2^23 limit for 998244353). Returns false as soon as a read comes back
+/// short or `sink` rejects a block. Takes O((N / B) * (M / B) * C(B)) time,
+/// where C(N) is the time complexity of `Convolution`, and reads each block of
+/// one operand once per block of the other.
+template <typename T, ConvolutionFunction<T> auto Convolution, typename ReadA,
+          typename ReadB, typename Sink>
+bool stream_convolution(std::size_t a_size, ReadA &&read_a, std::size_t b_size,
+                        ReadB &&read_b, Sink &&sink, std::size_t block_size) {
+  assert(block_size > 0);
+  if (a_size == 0 || b_size == 0) {
+    return true;
+  }
+  const std::size_t length = a_size + b_size - 1;
+  const std::size_t a_blocks = (a_size + block_size - 1) / block_size;
+  const std::size_t b_blocks = (b_size + block_size - 1) / block_size;
+  const auto read_block = [&](auto &read, std::size_t size, std::size_t i,
+                              std::vector<T> &block) {
+    const std::size_t count = std::min(block_size, size - i * block_size);
+    block = read(i * block_size, count);
+    return block.size() == count;
+  };
+
+  // The product of blocks a_i and b_j starts in output block d = i + j and
+  // ends in block d + 1, so output block d is complete after all pairs with
+  // i + j = d.
+  std::vector<T> current(block_size), next(block_size), a_block, b_block;
+  for (std::size_t d = 0; d * block_size < length; ++d) {
+    const std::size_t first = d < b_blocks ? 0 : d - b_blocks + 1;
+    for (std::size_t i = first; i < a_blocks && i <= d; ++i) {
+      if (!read_block(read_a, a_size, i, a_block) ||
+          !read_block(read_b, b_size, d - i, b_block)) {
+        return false;
+      }
+      const auto product = Convolution(a_block, b_block);
+      for (std::size_t k = 0; k < product.size(); ++k) {
+        (k < block_size ? current[k] : next[k - block_size]) += product[k];
+      }
+    }
+    current.resize(std::min(block_size, length - d * block_size));
+    if (!sink(std::as_const(current))) {
+      return false;
+    }
+    current.swap(next);
+    next.assign(block_size, T(0));
+  }
+  return true;
+}
+
+/// Returns the product of polynomials `a` and `b`, computed in memory by
+/// `stream_convolution` with blocks of at most `block_size` coefficients.
+template <typename T, ConvolutionFunction<T> auto Convolution>
+std::vector<T> block_convolution(const std::vector<T> &a,
+                                 const std::vector<T> &b,
+                                 std::size_t block_size) {
+  const auto reader = [](const std::vector<T> &v) {
+    return [&v](std::size_t offset, std::size_t count) {
+      return std::vector<T>(v.begin() + offset, v.begin() + offset + count);
+    };
+  };
+  std::vector<T> result;
+  if (!a.empty() && !b.empty()) {
+    result.reserve(a.size() + b.size() - 1);
+  }
+  stream_convolution<T, Convolution>(
+      a.size(), reader(a), b.size(), reader(b),
+      [&](const std::vector<T> &block) {
+        result.insert(result.end(), block.begin(), block.end());
+        return true;
+      },
+      block_size);
+  return result;
+}
+
+/// Returns the product of polynomials `a` and `b` for a `Convolution` that pads
+/// its product length up to a power of two, as NTTs typically do. Where the
+/// product length L is slightly above a power of two N, padding nearly doubles
+/// the work. Instead, the last (L - N) coefficients of the longer operand are
+/// split off, so that the rest multiplies in a transform of length exactly N,
+/// and the split-off part multiplies the other operand through
+/// `block_convolution` in short transforms. The split is made only when a
+/// simple model of transform cost favours it, which it does for L up to about
+/// 1.1N. The saving is largest at L = N + 1, where it removes nearly half of
+/// the work, and falls as L grows. Cost is not smooth in L: the split-off part
+/// is multiplied by one `Convolution` call per block of the other operand,
+/// which costs more than the model counts once there are hundreds of them. See
+/// `examples/benchmarks/split.cpp`. The Newton iterations of
+/// `FormalPowerSeries` already avoid such lengths through their precision
+/// schedule, so `inverse` and `exp` gain little from it.
+template <typename T, ConvolutionFunction<T> auto Convolution>
+std::vector<T> split_convolution(const std::vector<T> &a,
+                                 const std::vector<T> &b) {
+  if (a.size() < b.size()) {
+    return split_convolution<T, Convolution>(b, a);
+  }
+  if (b.empty()) {
+    return {};
+  }
+  const std::size_t length = a.size() + b.size() - 1;
+  const std::size_t floor = std::bit_floor(length);
+  const std::size_t excess = length - floor;
+  if (excess == 0 || floor < 64) {
+    return Convolution(a, b);
+  }
+
+  // Cost models, counting N log N for a transform of length N: padding runs
+  // transforms of length 2 * floor, while splitting runs them at length floor
+  // plus one of length 2 * block for each block of `b`.
+  const std::size_t block = std::bit_ceil(excess);
+  const std::size_t blocks = (b.size() + block - 1) / block;
+  const std::size_t padded_cost = 2 * floor * std::bit_width(2 * floor);
+  const std::size_t split_cost = floor * std::bit_width(floor) +
+                                 blocks * 2 * block * std::bit_width(2 * block);
+  if (split_cost >= padded_cost) {
+    return Convolution(a, b);
+  }
+
+  // a(x) = low(x) + x^h * high(x), where low has h = (a.size() - excess)
+  // terms, so that low(x) * b(x) has exactly `floor` terms.
+  const std::size_t h = a.size() - excess;
+  const std::vector<T> low(a.begin(), a.begin() + h);
+  const std::vector<T> high(a.begin() + h, a.end());
+  auto result = Convolution(low, b);
+  result.resize(length);
+  const auto high_product = block_convolution<T, Convolution>(high, b, block);
+  for (std::size_t i = 0; i < high_product.size(); ++i) {
+    result[h + i] += high_product[i];
+  }
+  return result;
+}
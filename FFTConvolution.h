@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+namespace fft_detail {
+
+using Complex = std::complex<double>;
+
+// Below this operand size, schoolbook multiplication is faster than the FFT.
+inline constexpr std::size_t NAIVE_THRESHOLD = 32;
+
+template <typename T>
+std::vector<T> naive_convolution(const std::vector<T> &a,
+                                 const std::vector<T> &b) {
+  std::vector<T> result(a.size() + b.size() - 1);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    for (std::size_t j = 0; j < b.size(); ++j) {
+      result[i + j] += a[i] * b[j];
+    }
+  }
+  return result;
+}
+
+/// In-place iterative radix-2 FFT of `a`, whose size is a power of two. Each
+/// root of unity is computed directly rather than by repeated multiplication,
+/// so that rounding errors do not accumulate across the transform.
+inline void fft(std::vector<Complex> &a, bool invert) {
+  const std::size_t n = a.size();
+  for (std::size_t i = 1, j = 0; i < n; ++i) {
+    std::size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(a[i], a[j]);
+    }
+  }
+  std::vector<Complex> roots(n / 2);
+  const double angle = (invert ? -2 : 2) * std::numbers::pi / n;
+  for (std::size_t k = 0; k < roots.size(); ++k) {
+    roots[k] = std::polar(1.0, angle * k);
+  }
+  for (std::size_t length = 2; length <= n; length <<= 1) {
+    const std::size_t half = length / 2, stride = n / length;
+    for (std::size_t i = 0; i < n; i += length) {
+      for (std::size_t j = 0; j < half; ++j) {
+        const auto u = a[i + j], v = a[i + j + half] * roots[j * stride];
+        a[i + j] = u + v;
+        a[i + j + half] = u - v;
+      }
+    }
+  }
+  if (invert) {
+    for (auto &x : a) {
+      x /= static_cast<double>(n);
+    }
+  }
+}
+
+template <typename T> double norm(const std::vector<T> &a) {
+  double sum = 0;
+  for (const auto &x : a) {
+    sum += std::norm(x);
+  }
+  return std::sqrt(sum);
+}
+
+} // namespace fft_detail
+
+/// Returns a bound on the absolute error of every coefficient of
+/// `fft_convolution(a, b)`: 16 * epsilon * (log2(N) + 1) * |a| * |b|, where N
+/// is the transform length and |.| is the Euclidean norm of the coefficients.
+/// This follows the first-order error analysis of FFT convolution by Percival,
+/// about 13 * log2(N) unit roundoffs, with room for the real-input packing.
+/// Typical errors are much smaller, as rounding errors mostly cancel.
+template <typename T>
+  requires std::same_as<T, double> || std::same_as<T, std::complex<double>>
+double fft_error_bound(const std::vector<T> &a, const std::vector<T> &b) {
+  if (a.empty() || b.empty()) {
+    return 0;
+  }
+  const auto n = std::bit_ceil(a.size() + b.size() - 1);
+  return 16 * std::numeric_limits<double>::epsilon() * std::bit_width(n) *
+         fft_detail::norm(a) * fft_detail::norm(b);
+}
+
+/// Returns the product of polynomials `a` and `b` with real coefficients,
+/// computed with a single forward and a single inverse complex FFT by packing
+/// `a` and `b` into the real and imaginary parts of one input. The error of
+/// each coefficient is at most `fft_error_bound(a, b)`.
+inline std::vector<double> fft_convolution(const std::vector<double> &a,
+                                           const std::vector<double> &b) {
+  using fft_detail::Complex;
+  if (a.empty() || b.empty()) {
+    return {};
+  }
+  if (std::min(a.size(), b.size()) <= fft_detail::NAIVE_THRESHOLD) {
+    return fft_detail::naive_convolution(a, b);
+  }
+  const std::size_t length = a.size() + b.size() - 1;
+  const std::size_t n = std::bit_ceil(length);
+  // Packing makes the error proportional to |a|^2 + |b|^2 rather than |a| *
+  // |b|, so b is first scaled by a power of two, exactly, to a similar norm.
+  const double norm_a = fft_detail::norm(a), norm_b = fft_detail::norm(b);
+  const int shift = norm_a > 0 && norm_b > 0
+                        ? std::ilogb(norm_a) - std::ilogb(norm_b)
+                        : 0;
+  std::vector<Complex> f(n);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    f[i].real(a[i]);
+  }
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    f[i].imag(std::ldexp(b[i], shift));
+  }
+  fft_detail::fft(f, false);
+  // With F = FFT(a + ib), FFT(a)_k = (F_k + conj(F_{-k})) / 2 and FFT(b)_k =
+  // (F_k - conj(F_{-k})) / 2i, so their product is (F_k^2 - conj(F_{-k})^2) /
+  // 4i.
+  std::vector<Complex> g(n);
+  for (std::size_t k = 0; k < n; ++k) {
+    const auto minus_k = (n - k) & (n - 1);
+    g[k] = (f[k] * f[k] - std::conj(f[minus_k] * f[minus_k])) *
+           Complex(0, -0.25);
+  }
+  fft_detail::fft(g, true);
+  std::vector<double> result(length);
+  for (std::size_t i = 0; i < length; ++i) {
+    result[i] = std::ldexp(g[i].real(), -shift);
+  }
+  return result;
+}
+
+/// Returns the product of polynomials `a` and `b` with complex coefficients,
+/// computed with complex FFTs. The error of each coefficient is at most
+/// `fft_error_bound(a, b)`.
+inline std::vector<std::complex<double>>
+fft_convolution(const std::vector<std::complex<double>> &a,
+                const std::vector<std::complex<double>> &b) {
+  if (a.empty() || b.empty()) {
+    return {};
+  }
+  if (std::min(a.size(), b.size()) <= fft_detail::NAIVE_THRESHOLD) {
+    return fft_detail::naive_convolution(a, b);
+  }
+  const std::size_t length = a.size() + b.size() - 1;
+  const std::size_t n = std::bit_ceil(length);
+  std::vector<std::complex<double>> fa(a), fb(b);
+  fa.resize(n);
+  fb.resize(n);
+  fft_detail::fft(fa, false);
+  fft_detail::fft(fb, false);
+  for (std::size_t k = 0; k < n; ++k) {
+    fa[k] *= fb[k];
+  }
+  fft_detail::fft(fa, true);
+  fa.resize(length);
+  return fa;
+}
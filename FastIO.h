@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/types.h>
+#endif
+
+/// Buffered reading of whitespace-separated integers from a C stream, for
+/// inputs too large for `std::cin >>` to parse quickly.
+class FastInput {
+public:
+  explicit FastInput(std::FILE *stream = stdin) noexcept : stream(stream) {}
+
+  FastInput(const FastInput &) = delete;
+
+  FastInput &operator=(const FastInput &) = delete;
+
+  /// Returns the next integer in the stream, or zero if it is exhausted.
+  template <std::integral T> T read() {
+    int c = next_char();
+    while (c != EOF && c <= ' ') {
+      c = next_char();
+    }
+    bool negative = false;
+    if constexpr (std::is_signed_v<T>) {
+      if (c == '-') {
+        negative = true;
+        c = next_char();
+      }
+    }
+    // Accumulated unsigned, so that the magnitude of the most negative value
+    // does not overflow.
+    std::make_unsigned_t<T> magnitude = 0;
+    for (; c >= '0' && c <= '9'; c = next_char()) {
+      magnitude = magnitude * 10 + static_cast<unsigned>(c - '0');
+    }
+    return static_cast<T>(negative ? 0 - magnitude : magnitude);
+  }
+
+private:
+  static constexpr std::size_t BUFFER_SIZE = 1 << 16;
+
+  std::FILE *stream;
+  std::array<char, BUFFER_SIZE> buffer;
+  std::size_t position = 0;
+  std::size_t length = 0;
+
+  int next_char() {
+    if (position == length) {
+      length = std::fread(buffer.data(), 1, BUFFER_SIZE, stream);
+      position = 0;
+      if (length == 0) {
+        return EOF;
+      }
+    }
+    return static_cast<unsigned char>(buffer[position++]);
+  }
+};
+
+/// Buffered writing of integers and characters to a C stream, flushed when
+/// full and on destruction.
+class FastOutput {
+public:
+  explicit FastOutput(std::FILE *stream = stdout) noexcept : stream(stream) {}
+
+  FastOutput(const FastOutput &) = delete;
+
+  FastOutput &operator=(const FastOutput &) = delete;
+
+  ~FastOutput() { flush(); }
+
+  template <std::integral T> void write(T value) {
+    // Enough for the 20 digits of a 64-bit integer and a sign.
+    if (length + 21 > BUFFER_SIZE) {
+      flush();
+    }
+    using Unsigned = std::make_unsigned_t<T>;
+    auto magnitude = static_cast<Unsigned>(value);
+    if constexpr (std::is_signed_v<T>) {
+      if (value < 0) {
+        buffer[length++] = '-';
+        magnitude = Unsigned(0) - magnitude;
+      }
+    }
+    std::array<char, 20> digits;
+    std::size_t count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude > 0);
+    while (count > 0) {
+      buffer[length++] = digits[--count];
+    }
+  }
+
+  void write(char c) {
+    if (length == BUFFER_SIZE) {
+      flush();
+    }
+    buffer[length++] = c;
+  }
+
+  void flush() {
+    std::fwrite(buffer.data(), 1, length, stream);
+    length = 0;
+    std::fflush(stream);
+  }
+
+private:
+  static constexpr std::size_t BUFFER_SIZE = 1 << 16;
+
+  std::FILE *stream;
+  std::array<char, BUFFER_SIZE> buffer;
+  std::size_t length = 0;
+};
+
+namespace fast_io_detail {
+
+template <std::size_t Bytes>
+void store_le(unsigned char *out, std::uint64_t value) {
+  for (std::size_t i = 0; i < Bytes; ++i) {
+    out[i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+}
+
+template <std::size_t Bytes> std::uint64_t load_le(const unsigned char *in) {
+  std::uint64_t value = 0;
+  for (std::size_t i = 0; i < Bytes; ++i) {
+    value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+  }
+  return value;
+}
+
+inline constexpr std::size_t CHUNK_SIZE = 1 << 14; // Coefficients per chunk.
+
+// Positions in a file as 64-bit offsets, through `fseeko` and `ftello` on
+// POSIX and `_fseeki64` and `_ftelli64` on Windows, so that files beyond 2 GiB
+// work even where `long` has 32 bits (on 32-bit POSIX, given a 64-bit `off_t`
+// from _FILE_OFFSET_BITS=64). Elsewhere, `fseek` and `ftell` are used. Either
+// way, positions beyond the offset type fail rather than wrap around.
+inline std::optional<std::int64_t> tell(std::FILE *stream) {
+#if defined(_WIN32)
+  const std::int64_t position = _ftelli64(stream);
+#elif defined(__unix__) || defined(__APPLE__)
+  const std::int64_t position = ftello(stream);
+#else
+  const std::int64_t position = std::ftell(stream);
+#endif
+  if (position < 0) {
+    return std::nullopt;
+  }
+  return position;
+}
+
+inline bool seek(std::FILE *stream, std::int64_t position) {
+#if defined(_WIN32)
+  return _fseeki64(stream, position, SEEK_SET) == 0;
+#elif defined(__unix__) || defined(__APPLE__)
+  return position <= std::numeric_limits<off_t>::max() &&
+         fseeko(stream, static_cast<off_t>(position), SEEK_SET) == 0;
+#else
+  return position <= std::numeric_limits<long>::max() &&
+         std::fseek(stream, static_cast<long>(position), SEEK_SET) == 0;
+#endif
+}
+
+template <typename ModInt>
+bool write_header(std::FILE *stream, std::uint64_t length) {
+  std::array<unsigned char, 16> header;
+  store_le<8>(header.data(), ModInt::mod());
+  store_le<8>(header.data() + 8, length);
+  return std::fwrite(header.data(), 1, header.size(), stream) == header.size();
+}
+
+template <typename ModInt>
+std::optional<std::uint64_t> read_header(std::FILE *stream) {
+  std::array<unsigned char, 16> header;
+  if (std::fread(header.data(), 1, header.size(), stream) != header.size() ||
+      load_le<8>(header.data()) != static_cast<std::uint64_t>(ModInt::mod())) {
+    return std::nullopt;
+  }
+  return load_le<8>(header.data() + 8);
+}
+
+template <typename ModInt>
+bool write_coefficients(std::FILE *stream, const std::vector<ModInt> &values) {
+  std::array<unsigned char, 4 * CHUNK_SIZE> chunk;
+  for (std::size_t i = 0; i < values.size(); i += CHUNK_SIZE) {
+    const auto count = std::min(CHUNK_SIZE, values.size() - i);
+    for (std::size_t j = 0; j < count; ++j) {
+      store_le<4>(chunk.data() + 4 * j, values[i + j].val());
+    }
+    if (std::fwrite(chunk.data(), 4, count, stream) != count) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Appends up to `count` coefficients from `stream` to `values`, growing it one
+// chunk at a time, and returns whether all of them were read.
+template <typename ModInt>
+bool read_coefficients(std::FILE *stream, std::uint64_t count,
+                       std::vector<ModInt> &values) {
+  std::array<unsigned char, 4 * CHUNK_SIZE> chunk;
+  while (count > 0) {
+    const auto chunk_count =
+        static_cast<std::size_t>(std::min<std::uint64_t>(CHUNK_SIZE, count));
+    const auto read = std::fread(chunk.data(), 4, chunk_count, stream);
+    for (std::size_t j = 0; j < read; ++j) {
+      values.push_back(ModInt(
+          static_cast<std::uint32_t>(load_le<4>(chunk.data() + 4 * j))));
+    }
+    if (read != chunk_count) {
+      return false;
+    }
+    count -= chunk_count;
+  }
+  return true;
+}
+
+} // namespace fast_io_detail
+
+/// Writes `series` to `stream` in a binary format, for checkpointing between
+/// computations: a header of the modulus and then the length, each as a
+/// little-endian 64-bit integer, followed by each coefficient as a
+/// little-endian 32-bit integer. Returns whether every byte was written.
+/// Requires coefficients to provide `mod()` and `val()`, as ACL's modints do.
+template <typename Series>
+bool write_binary(std::FILE *stream, const Series &series) {
+  using ModInt = typename Series::value_type;
+  return fast_io_detail::write_header<ModInt>(stream, series.size()) &&
+         fast_io_detail::write_coefficients<ModInt>(stream, series);
+}
+
+/// Reads a series written by `write_binary` from `stream`. Returns no value if
+/// the stream ends early or was written under a different modulus. Memory is
+/// only allocated for coefficients as they are read, so a corrupt length in
+/// the header cannot cause an oversized allocation.
+template <typename Series>
+std::optional<Series> read_binary(std::FILE *stream) {
+  using ModInt = typename Series::value_type;
+  const auto length = fast_io_detail::read_header<ModInt>(stream);
+  Series series;
+  if (!length ||
+      !fast_io_detail::read_coefficients<ModInt>(stream, *length, series)) {
+    return std::nullopt;
+  }
+  return series;
+}
+
+/// Random access to the coefficients of a series written by `write_binary`,
+/// read from the stream on demand rather than loaded into memory, for operands
+/// of `stream_convolution` too large to hold.
+template <typename ModInt> class BinarySeriesReader {
+public:
+  /// Reads a header at the current position of the seekable `stream`. Returns
+  /// no value if the stream ends early, was written under a different
+  /// modulus, or cannot report its position.
+  static std::optional<BinarySeriesReader> open(std::FILE *stream) {
+    const auto length = fast_io_detail::read_header<ModInt>(stream);
+    const auto start = fast_io_detail::tell(stream);
+    if (!length || !start) {
+      return std::nullopt;
+    }
+    return BinarySeriesReader(stream, *start, *length);
+  }
+
+  /// The length recorded in the header.
+  std::uint64_t size() const { return length; }
+
+  /// Returns the `count` coefficients starting at `offset`, or fewer if the
+  /// stream ends first or the position cannot be reached.
+  std::vector<ModInt> read(std::uint64_t offset, std::size_t count) const {
+    std::vector<ModInt> values;
+    constexpr auto max_position = std::numeric_limits<std::int64_t>::max();
+    if (offset <= static_cast<std::uint64_t>(max_position - start) / 4 &&
+        fast_io_detail::seek(stream,
+                             start + static_cast<std::int64_t>(4 * offset))) {
+      fast_io_detail::read_coefficients<ModInt>(stream, count, values);
+    }
+    return values;
+  }
+
+private:
+  std::FILE *stream;
+  std::int64_t start;
+  std::uint64_t length;
+
+  BinarySeriesReader(std::FILE *stream, std::int64_t start,
+                     std::uint64_t length)
+      : stream(stream), start(start), length(length) {}
+};
+
+/// Writes a series of known length to a stream in the format of
+/// `write_binary`, one block of coefficients at a time, as a sink for
+/// `stream_convolution`.
+template <typename ModInt> class BinarySeriesWriter {
+public:
+  /// Writes a header for a series of `length` coefficients to `stream`.
+  /// Returns no value if it cannot be written.
+  static std::optional<BinarySeriesWriter> open(std::FILE *stream,
+                                                std::uint64_t length) {
+    if (!fast_io_detail::write_header<ModInt>(stream, length)) {
+      return std::nullopt;
+    }
+    return BinarySeriesWriter(stream);
+  }
+
+  /// Appends `block` to the series. Returns whether every byte was written.
+  bool operator()(const std::vector<ModInt> &block) const {
+    return fast_io_detail::write_coefficients(stream, block);
+  }
+
+private:
+  std::FILE *stream;
+
+  explicit BinarySeriesWriter(std::FILE *stream) : stream(stream) {}
+};
@@ -1,8 +1,13 @@
 #include "FormalPowerSeries.h"
+#include "ModCombinatorics.h"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cmath>
+#include <limits>
 #include <ranges>
+#include <utility>
 
 template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>::FormalPowerSeries(
@@ -53,15 +58,10 @@ template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
 FormalPowerSeries<ModInt, Convolution>::operator+(
     const FormalPowerSeries &other) const {
-  const auto n = std::max(this->size(), other.size());
-  FormalPowerSeries result(n);
-  for (std::size_t i = 0; i < n; ++i) {
-    if (i < this->size()) {
-      result[i] += (*this)[i];
-    }
-    if (i < other.size()) {
-      result[i] += other[i];
-    }
+  FormalPowerSeries result(*this);
+  result.resize(std::max(this->size(), other.size()));
+  for (std::size_t i = 0; i < other.size(); ++i) {
+    result[i] += other[i];
   }
   return result;
 }
@@ -70,15 +70,10 @@ template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
 FormalPowerSeries<ModInt, Convolution>::operator-(
     const FormalPowerSeries &other) const {
-  const auto n = std::max(this->size(), other.size());
-  FormalPowerSeries result(n);
-  for (std::size_t i = 0; i < n; ++i) {
-    if (i < this->size()) {
-      result[i] += (*this)[i];
-    }
-    if (i < other.size()) {
-      result[i] -= other[i];
-    }
+  FormalPowerSeries result(*this);
+  result.resize(std::max(this->size(), other.size()));
+  for (std::size_t i = 0; i < other.size(); ++i) {
+    result[i] -= other[i];
   }
   return result;
 }
@@ -98,8 +93,10 @@ FormalPowerSeries<ModInt, Convolution>::derivative() const {
     return *this;
   }
   FormalPowerSeries result(this->size() - 1);
+  ModInt factor(0); // Equal to ModInt(i), without a reduction per element.
   for (std::size_t i = 1; i < this->size(); ++i) {
-    result[i - 1] = (*this)[i] * ModInt(i);
+    factor += ModInt(1);
+    result[i - 1] = (*this)[i] * factor;
   }
   return result;
 }
@@ -107,24 +104,34 @@ FormalPowerSeries<ModInt, Convolution>::derivative() const {
 template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
 FormalPowerSeries<ModInt, Convolution>::antiderivative() const {
+  const auto inverses = FormalPowerSeries::inverses(this->size());
   FormalPowerSeries result(this->size() + 1);
   for (std::size_t i = 1; i < result.size(); ++i) {
-    result[i] = (*this)[i - 1] / ModInt(i);
+    result[i] = (*this)[i - 1] * inverses[i];
   }
   return result;
 }
 
 template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
-FormalPowerSeries<ModInt, Convolution>::log(std::size_t size) const {
+FormalPowerSeries<ModInt, Convolution>::log(std::size_t size,
+                                            const Progress &progress) const {
   assert(!this->empty() && this->front() == ModInt(1));
-  // d/dx (ln P(x)) = P'(x) / P(x).
-  return (derivative() * inverse(size)).antiderivative().take(size);
+  // d/dx (ln P(x)) = P'(x) / P(x). Only the first `size` terms of P(x) affect
+  // the result, so we avoid multiplying by any more.
+  //
+  // If cancelled, the first t terms of the inverse still give the first (t +
+  // 1) terms of the logarithm.
+  const auto inv = inverse(size, progress);
+  return (take(size).derivative() * inv)
+      .antiderivative()
+      .take(std::min(size, inv.size() + 1));
 }
 
 template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
-FormalPowerSeries<ModInt, Convolution>::inverse(std::size_t size) const {
+FormalPowerSeries<ModInt, Convolution>::inverse(
+    std::size_t size, const Progress &progress) const {
   assert(!this->empty() && this->front() != ModInt(0));
   // Newton's Method: Q_{k+1} = Q_k - F(Q_k) / F'(Q_k) (mod x^{2^{k+1}}).
   //
@@ -137,18 +144,37 @@ FormalPowerSeries<ModInt, Convolution>::inverse(std::size_t size) const {
   // As a non-zero constant term of P(x) is a precondition, we can take the
   // multiplicative inverse of the constant term of P(x) as the initial Q_0
   // since it is the constant term of P(x)^{-1}.
-  FormalPowerSeries res = {ModInt(1) / this->front()};
-  while (res.size() != size) {
-    const auto next_size = std::min(res.size() * 2, size);
-    res = (res * (FormalPowerSeries{ModInt(2)} - take(next_size) * res))
-              .take(next_size);
-  }
-  return res;
+  return inverse(size, {ModInt(1) / this->front()}, progress);
 }
 
 template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
-FormalPowerSeries<ModInt, Convolution>::exp(std::size_t size) const {
+FormalPowerSeries<ModInt, Convolution>::inverse(
+    std::size_t size, FormalPowerSeries prefix,
+    const Progress &progress) const {
+  assert(!prefix.empty());
+  // Each iteration only depends on the previous iterate, so we can resume from
+  // any correct prefix, not just Q_0. See `inverse(std::size_t)`.
+  //
+  // Q_{k+1} = Q_k * (2 - P * Q_k) = Q_k - Q_k * (P * Q_k - 1), and P * Q_k - 1
+  // is zero modulo x^s, where s is the size of Q_k. So, writing P * Q_k - 1 =
+  // x^s * E, only the new terms -Q_k * E (mod x^{next_size - s}) need to be
+  // computed, keeping the second product at half the length.
+  return newton(std::move(prefix), size,
+                [this](const FormalPowerSeries &res, std::size_t next_size) {
+                  const auto s = res.size();
+                  auto error = (take(next_size) * res).take(next_size);
+                  // Divide by x^s.
+                  error.erase(error.begin(), error.begin() + s);
+                  return (res * error).take(next_size - s) * ModInt(-1);
+                },
+                progress);
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::exp(std::size_t size,
+                                            const Progress &progress) const {
   assert(!this->empty() && this->front() == ModInt(0));
   // Newton's Method: Q_{k+1} = Q_k - F(Q_k) / F'(Q_k) (mod x^{2^{k+1}}).
   //
@@ -160,20 +186,150 @@ FormalPowerSeries<ModInt, Convolution>::exp(std::size_t size) const {
   //
   // As a zero constant term of P(x) is a precondition, we can take 1 as the
   // initial Q_0 since it is the constant term of e^{P(x)}.
-  FormalPowerSeries res = {ModInt(1)};
-  while (res.size() != size) {
-    const auto next_size = std::min(res.size() * 2, size);
-    res = (res * (FormalPowerSeries{ModInt(1)} + take(next_size) -
-                  res.log(next_size)))
-              .take(next_size);
-  }
-  return res;
+  return exp(size, {ModInt(1)}, progress);
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::exp(
+    std::size_t size, FormalPowerSeries prefix,
+    const Progress &progress) const {
+  assert(!prefix.empty());
+  // As with `inverse`, we can resume from any correct prefix. See
+  // `exp(std::size_t)`.
+  //
+  // P - ln(Q_k) is zero modulo x^s, where s is the size of Q_k, so writing it
+  // as x^s * E, Q_{k+1} = Q_k + x^s * Q_k * E and only the new terms Q_k * E
+  // (mod x^{next_size - s}) need to be computed.
+  return newton(std::move(prefix), size,
+                [this](const FormalPowerSeries &res, std::size_t next_size) {
+                  const auto s = res.size();
+                  auto error = take(next_size) - res.log(next_size);
+                  // Divide by x^s.
+                  error.erase(error.begin(), error.begin() + s);
+                  return (res * error).take(next_size - s);
+                },
+                progress);
 }
 
 template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
 FormalPowerSeries<ModInt, Convolution>::pow(std::uint64_t k,
-                                            std::size_t size) const {
+                                            std::size_t size,
+                                            const Progress &progress) const {
+  const auto unit_pow = [&](const FormalPowerSeries &q, std::size_t n) {
+    const auto nonzeros = std::count_if(
+        q.begin() + 1, q.end(), [](const auto &x) { return x != ModInt(0); });
+    const auto method = pow_method(k, n, nonzeros);
+    if (method == PowMethod::Sparse) {
+      return q.unit_sparse_pow(k, n, progress);
+    }
+    if (method == PowMethod::BinPow) {
+      return q.bin_pow(k, n, progress);
+    }
+    // P^k(x) = exp(k * ln(P(x))). Since the coefficients of Q^k(x) are
+    // polynomials in k (with denominators dividing n!), reducing k modulo the
+    // modulus via ModInt(k) is exact, however large k is.
+    //
+    // The logarithm and the exponential each count as half of the work, so
+    // that reports increase across the two.
+    bool cancelled = false;
+    const auto log_q = q.log(n, [&](std::size_t done, std::size_t) {
+      cancelled = progress && !progress(done, 2 * n);
+      return !cancelled;
+    });
+    if (cancelled) { // Only Q^k(0) = 1 is known.
+      return FormalPowerSeries::mult_identity(1);
+    }
+    return (log_q * ModInt(k))
+        .exp(n, [&](std::size_t done, std::size_t) {
+          return !progress || progress(n + done, 2 * n);
+        });
+  };
+  return pow_with(k, size, unit_pow, progress);
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::sparse_pow(std::uint64_t k,
+                                                   std::size_t size) const {
+  return pow_with(k, size, [k](const FormalPowerSeries &q, std::size_t n) {
+    return q.unit_sparse_pow(k, n);
+  });
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr ModInt
+FormalPowerSeries<ModInt, Convolution>::pow_coefficient(std::uint64_t k,
+                                                        std::size_t n) const {
+  // As in `pow_with`, P(x) = a * x^i * Q(x) with Q(0) = 1, so [x^n]P^k(x) =
+  // a^k * [x^m]Q^k(x) for m = n - i * k.
+  if (k == 0) {
+    return ModInt(n == 0 ? 1 : 0);
+  }
+  const std::size_t terms = std::min(this->size(), n + 1);
+  std::size_t i = 0;
+  while (i < terms && (*this)[i] == ModInt(0)) {
+    ++i;
+  }
+  if (i == terms || i > n / k) { // P(x) is 0 (mod x^{n+1}), or i * k > n.
+    return ModInt(0);
+  }
+  const std::size_t m = n - i * k;
+  const auto a = (*this)[i];
+  const auto a_inv = ModInt(1) / a;
+
+  // The non-zero q_j for 0 < j <= m, and the degree d of Q(x) mod x^{m+1}.
+  std::vector<std::size_t> support;
+  std::vector<ModInt> q;
+  for (std::size_t j = 1; j <= m && i + j < terms; ++j) {
+    if ((*this)[i + j] != ModInt(0)) {
+      support.push_back(j);
+      q.push_back((*this)[i + j] * a_inv);
+    }
+  }
+  if (scale_out_of_range(a, k) ||
+      pow_method(k, m + 1, support.size()) != PowMethod::Sparse) {
+    return take(n + 1).pow(k, n + 1).back();
+  }
+  const std::size_t d = support.empty() ? 0 : support.back();
+
+  // The recurrence of `unit_sparse_pow`, m * r_m = sum_j q_j * (k * j - (m -
+  // j)) * r_{m-j}, reads only the previous d terms, so they are kept in a
+  // ring buffer. Rearranged as sum_j q_j * (k + 1) * j * r_{m-j} - m * sum_j
+  // q_j * r_{m-j}, each term needs only one product per sum.
+  std::vector<ModInt> weighted(q.size());
+  const ModInt k_plus_one = ModInt(k) + ModInt(1);
+  for (std::size_t s = 0; s < q.size(); ++s) {
+    weighted[s] = q[s] * k_plus_one * ModInt(support[s]);
+  }
+  std::vector<ModInt> ring(d + 1);
+  ring[0] = ModInt(1);
+  // Inverses of 1, ..., m, a window at a time so that memory stays O(d).
+  const std::size_t window = std::max<std::size_t>(d + 1, 1 << 10);
+  std::vector<ModInt> window_inverses;
+  for (std::size_t t = 1; t <= m; ++t) {
+    if ((t - 1) % window == 0) {
+      window_inverses = inverses(t, std::min(m + 1, t + window));
+    }
+    ModInt weighted_sum(0), sum(0);
+    for (std::size_t s = 0; s < support.size() && support[s] <= t; ++s) {
+      const auto &r = ring[(t - support[s]) % (d + 1)];
+      weighted_sum += weighted[s] * r;
+      sum += q[s] * r;
+    }
+    ring[t % (d + 1)] =
+        (weighted_sum - ModInt(t) * sum) * window_inverses[(t - 1) % window];
+  }
+  return scalar_pow(a, k) * ring[m % (d + 1)];
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+template <typename UnitPow>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::pow_with(
+    std::uint64_t k, std::size_t size, UnitPow unit_pow,
+    const Progress &progress) const {
   // We make no assumptions about the FPS, unlike in other methods, as it is
   // well-defined for any polynomial.
   //
@@ -201,38 +357,299 @@ FormalPowerSeries<ModInt, Convolution>::pow(std::uint64_t k,
     return FormalPowerSeries(size);
   } // i * k < size holds.
 
-  const auto a = (*this)[i];
-  // Q(x) = (P(x) / a) / x^i. Note that dividing by x^i is a left shift.
-  auto q = *this * (ModInt(1) / a);
-  q.erase(q.begin(), q.begin() + i); // Left shift.
-
   // P^k(x) = a^k * x^{ik} * Q^k(x). Multiplication by x^{ik} is a shift right
   // by i * k, meaning we only need to compute the first (size - i * k) terms
-  // of Q^k(x).
-  std::size_t n = size - i * k;
-  q = (q.log(n) * ModInt(k)).exp(n) * a.pow(k);
+  // of Q^k(x), and so only need the first (size - i * k) terms of Q(x).
+  const std::size_t n = size - i * k;
+  const auto a = (*this)[i];
+  // Q(x) = (P(x) / a) / x^i. Note that dividing by x^i is a left shift.
+  FormalPowerSeries q(this->begin() + i,
+                      this->begin() + std::min(this->size(), i + n));
+  if (scale_out_of_range(a, k)) {
+    // With floating-point coefficients, a^k and Q^k(x) could underflow and
+    // overflow even where their product, such as the distribution of a sum of
+    // k dice, is in range. Binary exponentiation of a * Q(x) keeps the scale
+    // in every product instead.
+    q = q.bin_pow(k, n, progress);
+  } else {
+    q *= ModInt(1) / a;
+    q[0] = ModInt(1); // Exactly, even where division is inexact.
+    q = unit_pow(q, n) * scalar_pow(a, k);
+  }
   q.insert(q.begin(), i * k, ModInt(0)); // Right shift, pad with zeros.
-  assert(q.size() == size);
+  assert(q.size() <= size); // Only less than `size` if cancelled.
 
   return q;
 }
 
 template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
-FormalPowerSeries<ModInt, Convolution>::bin_pow(std::uint64_t k,
-                                                std::size_t size) const {
+FormalPowerSeries<ModInt, Convolution>::unit_sparse_pow(
+    std::uint64_t k, std::size_t size, const Progress &progress) const {
+  assert(!this->empty() && this->front() == ModInt(1));
+  // Let R(x) = Q^k(x). Then R'(x) = k * Q'(x) * Q^{k-1}(x), so Q(x) * R'(x) =
+  // k * Q'(x) * R(x). Comparing coefficients of x^{m-1} and using Q(0) = 1:
+  //
+  // m * r_m = sum_{j >= 1} q_j * (k * j - (m - j)) * r_{m-j},
+  //
+  // where only the non-zero q_j contribute. As in `pow`, reducing k via
+  // ModInt(k) is exact.
+  std::vector<std::size_t> support;
+  for (std::size_t j = 1; j < std::min(this->size(), size); ++j) {
+    if ((*this)[j] != ModInt(0)) {
+      support.push_back(j);
+    }
+  }
+  const auto inverses = FormalPowerSeries::inverses(size);
+  const ModInt k_mod(k);
   FormalPowerSeries result = FormalPowerSeries::mult_identity(size);
+  for (std::size_t m = 1; m < size; ++m) {
+    ModInt sum(0);
+    for (const auto j : support) {
+      if (j > m) {
+        break;
+      }
+      sum += (*this)[j] * (k_mod * ModInt(j) - ModInt(m - j)) * result[m - j];
+    }
+    result[m] = sum * inverses[m];
+    if (progress && (std::has_single_bit(m + 1) || m + 1 == size) &&
+        !progress(m + 1, size)) {
+      result.resize(m + 1);
+      break;
+    }
+  }
+  return result;
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::bin_pow(
+    std::uint64_t k, std::size_t size, const Progress &progress) const {
+  if (k == 0) {
+    return FormalPowerSeries::mult_identity(size);
+  }
+  if (size == 0) {
+    return {};
+  }
+  // One squaring per bit of k below the leading one, and one multiplication
+  // into the result per set bit after the lowest.
+  const auto products =
+      static_cast<std::size_t>(std::bit_width(k) + std::popcount(k) - 2);
+  std::size_t done = 0;
+  const auto cancelled = [&] {
+    return progress && !progress(++done, products);
+  };
+  // Only the constant term, P(0)^k, is known on cancellation.
+  const auto constant_term = [&] {
+    return FormalPowerSeries{scalar_pow(this->empty() ? ModInt(0) : (*this)[0],
+                                        k)};
+  };
+  FormalPowerSeries result; // Empty until the lowest set bit of k.
   FormalPowerSeries power = this->take(size);
-  while (k > 0) {
-    if (k & 1) {
-      result = (result * power).take(size);
+  for (auto bits = k;;) {
+    if (bits & 1) {
+      if (result.empty()) {
+        result = power;
+      } else {
+        result = (result * power).take(size);
+        if (cancelled()) {
+          return constant_term();
+        }
+      }
+    }
+    if ((bits >>= 1) == 0) {
+      return result;
     }
     power = (power * power).take(size);
-    k >>= 1;
+    if (cancelled()) {
+      return constant_term();
+    }
+  }
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr std::vector<ModInt>
+FormalPowerSeries<ModInt, Convolution>::evaluate_geometric(
+    const ModInt &a, const ModInt &r, std::size_t m) const {
+  assert(r != ModInt(0));
+  const auto n = this->size();
+  if (n == 0 || m == 0) {
+    return std::vector<ModInt>(m);
+  }
+  // Bluestein's identity i * j = C(i + j, 2) - C(i, 2) - C(j, 2), where C(t,
+  // 2) = t * (t - 1) / 2, gives
+  //
+  // P(a * r^i) = sum_j p_j * a^j * r^{ij}
+  //            = r^{-C(i, 2)} * sum_j u_j * w_{i+j},
+  //
+  // for u_j = p_j * a^j * r^{-C(j, 2)} and w_t = r^{C(t, 2)}. The sum is a
+  // correlation, which is the convolution of w with u reversed.
+  //
+  // As C(t + 1, 2) = C(t, 2) + t, consecutive powers r^{C(t, 2)} differ by a
+  // factor of r^t, so no exponentiation is needed.
+  const auto r_inv = ModInt(1) / r;
+  FormalPowerSeries u(n);
+  ModInt a_power(1), chirp_inv(1), r_inv_power(1);
+  for (std::size_t j = 0; j < n; ++j) {
+    u[n - 1 - j] = (*this)[j] * a_power * chirp_inv;
+    a_power *= a;
+    chirp_inv *= r_inv_power;
+    r_inv_power *= r_inv;
+  }
+  FormalPowerSeries w(n + m - 1);
+  ModInt chirp(1), r_power(1);
+  for (std::size_t t = 0; t < w.size(); ++t) {
+    w[t] = chirp;
+    chirp *= r_power;
+    r_power *= r;
+  }
+  const auto correlation = u * w;
+
+  std::vector<ModInt> result(m);
+  chirp_inv = r_inv_power = ModInt(1);
+  for (std::size_t i = 0; i < m; ++i) {
+    result[i] = correlation[n - 1 + i] * chirp_inv;
+    chirp_inv *= r_inv_power;
+    r_inv_power *= r_inv;
   }
   return result;
 }
 
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::interpolate_geometric(
+    const ModInt &a, const ModInt &r, const std::vector<ModInt> &values) {
+  assert(a != ModInt(0) && r != ModInt(0));
+  const auto n = values.size();
+  if (n == 0) {
+    return {};
+  }
+  // Write x_i = a * r^i. By Lagrange interpolation, P(x) = M(x) * sum_i c_i /
+  // (x - x_i), where M(x) = prod_i (x - x_i) and c_i = y_i / prod_{j != i} (x_i
+  // - x_j). As P(x) has fewer than N terms, it is the first N terms of the
+  // product of M(x) with the power series S(x) = sum_i c_i / (x - x_i).
+  //
+  // With F_t = prod_{s=1}^{t} (1 - r^s), the denominators simplify to
+  // prod_{j != i} (x_i - x_j) = (-1)^i * a^{N-1} * r^{C(i, 2) + i(N-1-i)} *
+  // F_i * F_{N-1-i}, so all of their inverses follow from the single inverse
+  // of F_{N-1}.
+  std::vector<ModInt> powers(n + 1), f(n), f_inv(n);
+  powers[0] = f[0] = ModInt(1);
+  for (std::size_t t = 1; t <= n; ++t) {
+    powers[t] = powers[t - 1] * r;
+  }
+  for (std::size_t t = 1; t < n; ++t) {
+    f[t] = f[t - 1] * (ModInt(1) - powers[t]);
+  }
+  f_inv[n - 1] = ModInt(1) / f[n - 1];
+  for (std::size_t t = n - 1; t > 0; --t) {
+    f_inv[t - 1] = f_inv[t] * (ModInt(1) - powers[t]);
+  }
+
+  const auto a_inv = ModInt(1) / a, r_inv = ModInt(1) / r;
+  const auto scale = scalar_pow(a_inv, n - 1);
+  FormalPowerSeries c(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint64_t exponent = i * (i - 1) / 2 + i * (n - 1 - i);
+    c[i] = values[i] * scale * scalar_pow(r_inv, exponent) * f_inv[i] *
+           f_inv[n - 1 - i];
+    if (i & 1) {
+      c[i] = -c[i];
+    }
+  }
+
+  // [x^k] S(x) = -sum_i c_i * x_i^{-(k+1)} = -a^{-(k+1)} * C(r^{-(k+1)}),
+  // where C(y) = sum_i c_i * y^i, so S(x) is itself a geometric evaluation.
+  const auto sums = c.evaluate_geometric(r_inv, r_inv, n);
+  FormalPowerSeries s(n);
+  ModInt a_inv_power = a_inv;
+  for (std::size_t k = 0; k < n; ++k) {
+    s[k] = -a_inv_power * sums[k];
+    a_inv_power *= a_inv;
+  }
+
+  // [x^{N-k}] M(x) = (-a)^k * e_k, where e_k is the k-th elementary symmetric
+  // polynomial of 1, r, ..., r^{N-1}. By the q-binomial theorem, e_k / e_{k-1}
+  // = r^{k-1} * (1 - r^{N-k+1}) / (1 - r^k), and e_N = r^{C(N, 2)} directly,
+  // as 1 - r^N may be zero.
+  FormalPowerSeries m(n + 1);
+  ModInt e(1), minus_a_power(1);
+  m[n] = ModInt(1);
+  for (std::size_t k = 1; k < n; ++k) {
+    e *= powers[k - 1] * (ModInt(1) - powers[n - k + 1]) * f_inv[k] * f[k - 1];
+    minus_a_power *= -a;
+    m[n - k] = minus_a_power * e;
+  }
+  m[0] = minus_a_power * -a * scalar_pow(r, std::uint64_t(n) * (n - 1) / 2);
+
+  return (m * s).take(n);
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+template <typename Equation, typename Derivative>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::solve_newton(
+    Equation equation, Derivative derivative, FormalPowerSeries prefix,
+    std::size_t size) {
+  assert(!prefix.empty());
+  // Newton's Method: Y_{k+1} = Y_k - F(Y_k) / F'(Y_k). As F(Y_k) is zero
+  // modulo x^s, where s is the size of Y_k, writing F(Y_k) = x^s * E, the new
+  // terms are -E / F'(Y_k) (mod x^{next_size - s}).
+  return newton(std::move(prefix), size,
+                [&](const FormalPowerSeries &res, std::size_t next_size) {
+                  const auto s = res.size();
+                  auto error = FormalPowerSeries(equation(res, next_size))
+                                   .take(next_size);
+                  // Divide by x^s.
+                  error.erase(error.begin(), error.begin() + s);
+                  const auto slope =
+                      FormalPowerSeries(derivative(res, next_size - s));
+                  return (error * slope.inverse(next_size - s))
+                             .take(next_size - s) *
+                         ModInt(-1);
+                });
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::solve_linear_ode(
+    const FormalPowerSeries &a, const FormalPowerSeries &b,
+    const ModInt &initial, std::size_t size) {
+  if (size == 0) {
+    return {};
+  }
+  // With the integrating factor E(x) = exp(integral of A(x)), which satisfies
+  // E'(x) = A(x) * E(x), the equation becomes (Y(x) / E(x))' = B(x) / E(x).
+  // Integrating, Y(x) = E(x) * (Y(0) + integral of B(x) / E(x)), as E(0) = 1.
+  // Only the first (size - 1) terms of A(x) and B(x) affect the result.
+  const auto factor = a.take(size - 1).antiderivative().exp(size);
+  auto integral = (b.take(size - 1) * factor.inverse(size - 1))
+                      .take(size - 1)
+                      .antiderivative();
+  integral[0] = initial;
+  return (factor * integral).take(size);
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+template <typename NewTerms>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::newton(FormalPowerSeries prefix,
+                                               std::size_t size,
+                                               NewTerms new_terms,
+                                               const Progress &progress) {
+  FormalPowerSeries res = std::move(prefix);
+  res.resize(std::min(res.size(), size));
+  for (const auto next_size : precision_schedule(res.size(), size)) {
+    const auto terms = new_terms(std::as_const(res), next_size);
+    assert(terms.size() == next_size - res.size());
+    res.insert(res.end(), terms.begin(), terms.end());
+    if (progress && !progress(res.size(), size)) {
+      break;
+    }
+  }
+  return res;
+}
+
 template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
 constexpr FormalPowerSeries<ModInt, Convolution>
 FormalPowerSeries<ModInt, Convolution>::mult_identity(std::size_t size) {
@@ -243,3 +660,155 @@ FormalPowerSeries<ModInt, Convolution>::mult_identity(std::size_t size) {
   result[0] = ModInt(1);
   return result;
 }
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr std::vector<std::size_t>
+FormalPowerSeries<ModInt, Convolution>::precision_schedule(std::size_t from,
+                                                           std::size_t to) {
+  // Doubling from `from` overshoots whenever `to` is just above a power of
+  // two, leaving a final iteration that gains few terms for the cost of a
+  // full one. Halving down from `to` (rounding up) instead keeps every
+  // iteration close to doubling, with the sizes of products growing smoothly
+  // with `to`.
+  std::vector<std::size_t> schedule;
+  for (auto size = to; size > from; size = (size + 1) / 2) {
+    schedule.push_back(size);
+  }
+  std::ranges::reverse(schedule);
+  return schedule;
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr std::vector<ModInt>
+FormalPowerSeries<ModInt, Convolution>::inverses(std::size_t n) {
+  if constexpr (is_floating_point_coefficient_v<ModInt>) {
+    std::vector<ModInt> result(n + 1);
+    for (std::size_t i = 1; i <= n; ++i) {
+      result[i] = ModInt(1) / ModInt(i);
+    }
+    return result;
+  } else {
+    // Dividing by each i directly costs a modular inverse per element, so we
+    // precompute all of them from a single inverse instead.
+    return ModCombinatorics<ModInt>(n).inverses;
+  }
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr std::vector<ModInt>
+FormalPowerSeries<ModInt, Convolution>::inverses(std::size_t first,
+                                                 std::size_t last) {
+  std::vector<ModInt> result(last - first);
+  if constexpr (is_floating_point_coefficient_v<ModInt>) {
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      result[i] = ModInt(1) / ModInt(first + i);
+    }
+  } else if (!result.empty()) {
+    // With prefix products p_i = first * ... * (first + i), 1 / (first + i) =
+    // p_{i-1} / p_i, and each 1 / p_{i-1} follows from 1 / p_i.
+    std::vector<ModInt> prefix(result.size());
+    prefix[0] = ModInt(first);
+    for (std::size_t i = 1; i < prefix.size(); ++i) {
+      prefix[i] = prefix[i - 1] * ModInt(first + i);
+    }
+    auto inverse = ModInt(1) / prefix.back();
+    for (std::size_t i = result.size() - 1; i > 0; --i) {
+      result[i] = inverse * prefix[i - 1];
+      inverse *= ModInt(first + i);
+    }
+    result[0] = inverse;
+  }
+  return result;
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr bool
+FormalPowerSeries<ModInt, Convolution>::scale_out_of_range(ModInt base,
+                                                           std::uint64_t k) {
+  if constexpr (is_floating_point_coefficient_v<ModInt>) {
+    using Real = decltype(std::abs(base));
+    // |base|^k = 2^e with e = k * log2|base|.
+    const auto exponent = static_cast<Real>(k) * std::log2(std::abs(base));
+    return std::abs(exponent) > std::numeric_limits<Real>::max_exponent / 2;
+  } else {
+    return false;
+  }
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr typename FormalPowerSeries<ModInt, Convolution>::PowMethod
+FormalPowerSeries<ModInt, Convolution>::pow_method(std::uint64_t k,
+                                                   std::size_t size,
+                                                   std::size_t nonzeros) {
+  // Rough operation counts for each method: a convolution of n terms costs
+  // about three transforms of length 2n, `bin_pow` performs one convolution
+  // per bit of k and one per set bit, `log` followed by `exp` costs about 14
+  // convolutions in total across their Newton iterations, and the sparse
+  // recurrence costs two products per term per non-zero coefficient.
+  const std::uint64_t convolution_cost = 3 * size * std::bit_width(2 * size);
+  const std::uint64_t bin_pow_cost =
+      (std::bit_width(k) + std::popcount(k) - 1) * convolution_cost;
+  const std::uint64_t log_exp_cost = 14 * convolution_cost;
+  const std::uint64_t sparse_cost = 2 * size * nonzeros;
+  if (sparse_cost <= std::min(bin_pow_cost, log_exp_cost)) {
+    return PowMethod::Sparse;
+  }
+  return bin_pow_cost <= log_exp_cost ? PowMethod::BinPow : PowMethod::LogExp;
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr ModInt
+FormalPowerSeries<ModInt, Convolution>::scalar_pow(ModInt base,
+                                                   std::uint64_t k) {
+  ModInt result(1);
+  while (k > 0) {
+    if (k & 1) {
+      result *= base;
+    }
+    base *= base;
+    k >>= 1;
+  }
+  return result;
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+template <std::ranges::input_range Range>
+  requires std::convertible_to<std::ranges::range_reference_t<Range>,
+                               FormalPowerSeries<ModInt, Convolution>>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::product_of(Range &&factors) {
+  // Elements of a range are copied even if the range itself is an rvalue, as
+  // they may be references into a container owned elsewhere. Callers that own
+  // their factors can avoid this by moving a std::vector of them instead.
+  std::vector<FormalPowerSeries> owned;
+  for (auto &&factor : factors) {
+    owned.emplace_back(std::forward<decltype(factor)>(factor));
+  }
+  return product_of(std::move(owned));
+}
+
+template <typename ModInt, ConvolutionFunction<ModInt> auto Convolution>
+constexpr FormalPowerSeries<ModInt, Convolution>
+FormalPowerSeries<ModInt, Convolution>::product_of(
+    std::vector<FormalPowerSeries> &&factors) {
+  // A min-heap on size, built in place in `factors`. Factors are moved in and
+  // out of the heap, so no coefficients are copied.
+  const auto larger = [](const FormalPowerSeries &a,
+                         const FormalPowerSeries &b) {
+    return a.size() > b.size();
+  };
+  auto &heap = factors;
+  if (heap.empty()) {
+    return FormalPowerSeries::mult_identity(1);
+  }
+  std::ranges::make_heap(heap, larger);
+  while (heap.size() > 1) {
+    std::ranges::pop_heap(heap, larger);
+    auto smallest = std::move(heap.back());
+    heap.pop_back();
+    std::ranges::pop_heap(heap, larger);
+    heap.back() = heap.back() * smallest;
+    std::ranges::push_heap(heap, larger);
+  }
+  return std::move(heap.front());
+}
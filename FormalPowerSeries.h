@@ -1,9 +1,12 @@
 #pragma once
 
+#include <complex>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <iterator>
+#include <ranges>
 #include <type_traits>
 #include <vector>
 
@@ -13,6 +16,17 @@ concept ConvolutionFunction = requires(F f, const std::vector<T> &a,
   { f(a, b) } -> std::same_as<std::vector<T>>;
 };
 
+/// Whether coefficients of type T are real or complex floating-point numbers,
+/// rather than modular integers. Division is then cheap, but factorials soon
+/// overflow.
+template <typename T>
+inline constexpr bool is_floating_point_coefficient_v =
+    std::is_floating_point_v<T>;
+
+template <typename T>
+inline constexpr bool is_floating_point_coefficient_v<std::complex<T>> =
+    std::is_floating_point_v<T>;
+
 /// Formal Power Series operations that rely on a provided convolution function
 /// to multiply polynomials. A polynomial of degree n is represented as a
 /// std::vector of coefficients of size (n + 1) whose i-th element is the
@@ -23,6 +37,16 @@ class FormalPowerSeries : public std::vector<ModInt> {
 public:
   using Base = std::vector<ModInt>;
 
+  /// Observes a long-running operation, being called after each of its
+  /// iterations with the work done so far and the total work, in the same
+  /// units. Across one operation, the total is fixed, the work done strictly
+  /// increases, and it reaches the total on the last call unless cancelled.
+  /// Returning false cancels the operation, which then returns only the
+  /// leading terms it has computed (and so fewer than requested). A cancelled
+  /// `inverse` or `exp` can be resumed from its result with the overloads
+  /// taking a prefix.
+  using Progress = std::function<bool(std::size_t done, std::size_t total)>;
+
   constexpr FormalPowerSeries() noexcept = default;
 
   explicit constexpr FormalPowerSeries(std::size_t n);
@@ -67,50 +91,221 @@ public:
 
   /// Returns the first `size` terms of the formal power series that is the
   /// natural logarithm of this formal power series.
+  /// Progress is reported through `progress` from the underlying `inverse`.
   /// Precondition: this polynomial is non-empty with constant term of one.
-  [[nodiscard]] constexpr FormalPowerSeries log(std::size_t size) const;
+  [[nodiscard]] constexpr FormalPowerSeries
+  log(std::size_t size, const Progress &progress = {}) const;
 
   /// Returns the first `size` terms of the formal power series that is the
   /// multiplicative inverse of this formal power series.
+  /// Progress is reported through `progress`, if given, in terms computed.
   /// Precondition: this polynomial is non-empty with a non-zero constant term.
-  [[nodiscard]] constexpr FormalPowerSeries inverse(std::size_t size) const;
+  [[nodiscard]] constexpr FormalPowerSeries
+  inverse(std::size_t size, const Progress &progress = {}) const;
+
+  /// Returns the first `size` terms of the formal power series that is the
+  /// multiplicative inverse of this formal power series, resuming Newton's
+  /// method from `prefix`, some number of leading terms of that inverse (for
+  /// example, the result of an earlier call with a smaller `size`). Only the
+  /// iterations beyond `prefix.size()` terms are performed.
+  /// Precondition: `prefix` is non-empty and a prefix of the inverse.
+  [[nodiscard]] constexpr FormalPowerSeries
+  inverse(std::size_t size, FormalPowerSeries prefix,
+          const Progress &progress = {}) const;
 
   /// Returns the first `size` terms of the formal power series that is e raised
   /// to the power of this formal power series.
+  /// Progress is reported through `progress`, if given, in terms computed.
   /// Precondition: this polynomial is non-empty with a zero constant term.
-  [[nodiscard]] constexpr FormalPowerSeries exp(std::size_t size) const;
+  [[nodiscard]] constexpr FormalPowerSeries
+  exp(std::size_t size, const Progress &progress = {}) const;
+
+  /// Returns the first `size` terms of the formal power series that is e raised
+  /// to the power of this formal power series, resuming Newton's method from
+  /// `prefix`, some number of leading terms of that exponential (for example,
+  /// the result of an earlier call with a smaller `size`). Only the iterations
+  /// beyond `prefix.size()` terms are performed.
+  /// Precondition: `prefix` is non-empty and a prefix of the exponential.
+  [[nodiscard]] constexpr FormalPowerSeries
+  exp(std::size_t size, FormalPowerSeries prefix,
+      const Progress &progress = {}) const;
 
   /// Returns the first `size` terms of the formal power series that is this
   /// formal power series raised to the power of `k`, where `k` is a
-  /// non-negative integer.
-  [[nodiscard]] constexpr FormalPowerSeries pow(std::uint64_t k,
-                                                std::size_t size) const;
+  /// non-negative integer. Picks whichever of `bin_pow`, `sparse_pow`, or
+  /// exponentiation through `log` and `exp` is estimated to be cheapest.
+  /// Progress is reported through `progress` by the `sparse_pow` recurrence,
+  /// in terms computed, at each power of two and on completion. Through `log`
+  /// and `exp`, each counts as half of the total, with `log` reporting the
+  /// terms of its inverse and `exp` its own. Through `bin_pow`, in products
+  /// computed. If cancelled, only the known leading terms are returned.
+  /// For floating-point coefficients, `bin_pow` is also used where a^k, for
+  /// the lowest non-zero coefficient a, would leave the range of exponents.
+  [[nodiscard]] constexpr FormalPowerSeries
+  pow(std::uint64_t k, std::size_t size, const Progress &progress = {}) const;
+
+  /// Returns the first `size` terms of the formal power series that is this
+  /// formal power series raised to the power of `k`, where `k` is a
+  /// non-negative integer, using a coefficient recurrence in O(size * S) time,
+  /// where S is the number of non-zero coefficients of this formal power
+  /// series. Generally faster than `FormalPowerSeries::pow` only when S is
+  /// small. Falls back to `bin_pow` as `pow` does for floating-point
+  /// coefficients.
+  [[nodiscard]] constexpr FormalPowerSeries sparse_pow(std::uint64_t k,
+                                                       std::size_t size) const;
+
+  /// Returns the coefficient of x^n in the formal power series that is this
+  /// formal power series raised to the power of `k`, where `k` is a
+  /// non-negative integer. Only the first (n + 1) terms of this formal power
+  /// series are read. Where `pow` would pick the `sparse_pow` recurrence, it is
+  /// run over a sliding window instead, in O(n * S) time and O(D) memory, where
+  /// S and D are the number of non-zero terms and the degree of those (n + 1)
+  /// terms after dividing out the lowest power of x. Otherwise, this costs as
+  /// much as `pow(k, n + 1)`.
+  [[nodiscard]] constexpr ModInt pow_coefficient(std::uint64_t k,
+                                                 std::size_t n) const;
 
   /// Returns the first `size` terms of the formal power series that is this
   /// formal power series raised to the power of `k`, where `k` is a
   /// non-negative integer, using naive binary exponentiation in
   /// O(C(size) * log K) time, where C(N) is the time complexity of convolution.
   /// Generally slower than `FormalPowerSeries::pow` when C(N) is O(N log N).
-  [[nodiscard]] constexpr FormalPowerSeries bin_pow(std::uint64_t k,
-                                                    std::size_t size) const;
+  /// Progress is reported through `progress`, if given, in products computed,
+  /// after each product. If cancelled, only the constant term is returned.
+  [[nodiscard]] constexpr FormalPowerSeries
+  bin_pow(std::uint64_t k, std::size_t size,
+          const Progress &progress = {}) const;
+
+  /// Returns the values of this polynomial at the `m` points a * r^i for 0 <= i
+  /// < m, via Bluestein's chirp-z transform, which reduces the evaluation to a
+  /// single convolution. Takes O(C(N + M)) time for a polynomial of size N.
+  /// Precondition: `r` is non-zero.
+  [[nodiscard]] constexpr std::vector<ModInt>
+  evaluate_geometric(const ModInt &a, const ModInt &r, std::size_t m) const;
+
+  /// Returns the unique polynomial of size N = `values.size()` whose value at
+  /// a * r^i is `values[i]` for each 0 <= i < N, in O(C(N)) time.
+  /// Precondition: `a` and `r` are non-zero, and r^i != 1 for 0 < i < N, so
+  /// that the points are distinct.
+  [[nodiscard]] static constexpr FormalPowerSeries
+  interpolate_geometric(const ModInt &a, const ModInt &r,
+                        const std::vector<ModInt> &values);
+
+  /// Returns the first `size` terms of the formal power series Y(x) satisfying
+  /// the equation F(Y) = 0, by Newton's method from `prefix`, some number of
+  /// leading terms of Y(x) (at least its constant term). `equation(y, n)` and
+  /// `derivative(y, n)` must return (at least) the first n terms of F(y) and
+  /// of the partial derivative of F with respect to Y at y, respectively. For
+  /// example, T(x) = x * e^{T(x)} is solved from the prefix {0} with F(T) = T -
+  /// x * e^T and dF/dT = 1 - x * e^T. Takes O(C(size)) time, excluding the
+  /// cost of the callbacks.
+  /// Precondition: F(prefix) is zero modulo x^{prefix.size()}, and dF/dY at
+  /// `prefix` has a non-zero constant term.
+  template <typename Equation, typename Derivative>
+  [[nodiscard]] static constexpr FormalPowerSeries
+  solve_newton(Equation equation, Derivative derivative,
+               FormalPowerSeries prefix, std::size_t size);
+
+  /// Returns the first `size` terms of the formal power series Y(x) solving the
+  /// first-order linear differential equation Y'(x) = A(x) * Y(x) + B(x) with
+  /// Y(0) = `initial`, where A(x) and B(x) are `a` and `b`, in O(C(size))
+  /// time.
+  [[nodiscard]] static constexpr FormalPowerSeries
+  solve_linear_ode(const FormalPowerSeries &a, const FormalPowerSeries &b,
+                   const ModInt &initial, std::size_t size);
 
   /// Returns the first `size` terms of the formal power series P(x) = 1.
   [[nodiscard]] static constexpr FormalPowerSeries
   mult_identity(std::size_t size);
 
-  template <typename ModIntT, ConvolutionFunction<ModIntT> auto ConvolutionT>
-  constexpr friend FormalPowerSeries<ModIntT, ConvolutionT>
-  operator*(const FormalPowerSeries<ModIntT, ConvolutionT> &fps,
-            const ModIntT &scalar) {
+  /// Returns the product of all formal power series in `factors`, or P(x) = 1
+  /// if there are none. The two smallest remaining factors are always
+  /// multiplied together first (as in Huffman coding), keeping convolutions
+  /// balanced even for many factors of differing sizes. For K factors of total
+  /// size N, this takes O(C(N) * log K) time.
+  template <std::ranges::input_range Range>
+    requires std::convertible_to<std::ranges::range_reference_t<Range>,
+                                 FormalPowerSeries>
+  [[nodiscard]] static constexpr FormalPowerSeries product_of(Range &&factors);
+
+  /// As above, but takes ownership of `factors`, so that no factor is copied.
+  [[nodiscard]] static constexpr FormalPowerSeries
+  product_of(std::vector<FormalPowerSeries> &&factors);
+
+  constexpr friend FormalPowerSeries operator*(const FormalPowerSeries &fps,
+                                               const ModInt &scalar) {
     return FormalPowerSeries(fps) *= scalar;
   }
 
-  template <typename ModIntT, ConvolutionFunction<ModIntT> auto ConvolutionT>
-  constexpr friend FormalPowerSeries<ModIntT, ConvolutionT>
-  operator*(const ModIntT &scalar,
-            const FormalPowerSeries<ModIntT, ConvolutionT> &fps) {
+  constexpr friend FormalPowerSeries operator*(const ModInt &scalar,
+                                               const FormalPowerSeries &fps) {
     return fps * scalar;
   }
+
+private:
+  /// Returns the increasing sizes, ending in `to`, through which a Newton
+  /// iteration should extend a result of size `from`, each at most double the
+  /// size before it. Precondition: `from` is positive.
+  [[nodiscard]] static constexpr std::vector<std::size_t>
+  precision_schedule(std::size_t from, std::size_t to);
+
+  /// Returns a std::vector whose i-th element is the multiplicative inverse of
+  /// i, for each 0 < i <= n.
+  [[nodiscard]] static constexpr std::vector<ModInt> inverses(std::size_t n);
+
+  /// Returns a std::vector whose i-th element is the multiplicative inverse of
+  /// (first + i), for each first <= first + i < last, with a single inverse.
+  /// Precondition: 0 < first <= last.
+  [[nodiscard]] static constexpr std::vector<ModInt> inverses(std::size_t first,
+                                                             std::size_t last);
+
+  /// Returns `prefix` extended to `size` terms by a Newton iteration, where
+  /// `new_terms(res, next_size)` must return the terms of the next iterate
+  /// beyond those of the current iterate `res`, up to `next_size` terms.
+  /// `progress`, if given, is called after each iteration with the number of
+  /// terms computed and `size`.
+  template <typename NewTerms>
+  [[nodiscard]] static constexpr FormalPowerSeries
+  newton(FormalPowerSeries prefix, std::size_t size, NewTerms new_terms,
+         const Progress &progress = {});
+
+  /// Returns `base` raised to the power of `k`, for any 64-bit `k`.
+  [[nodiscard]] static constexpr ModInt scalar_pow(ModInt base,
+                                                   std::uint64_t k);
+
+  /// Returns whether, for floating-point coefficients, `base` raised to the
+  /// power of `k` is too far from 1 for `pow_with` to factor out: its exponent
+  /// would exceed half of the range, leaving too little for Q^k(x).
+  [[nodiscard]] static constexpr bool scale_out_of_range(ModInt base,
+                                                         std::uint64_t k);
+
+  /// The methods by which `pow` may compute Q^k(x) for Q(0) = 1.
+  enum class PowMethod { Sparse, BinPow, LogExp };
+
+  /// Returns the method estimated to compute the first `size` terms of Q^k(x)
+  /// most cheaply, where Q(0) = 1 and Q(x) has `nonzeros` further non-zero
+  /// terms among its first `size`.
+  [[nodiscard]] static constexpr PowMethod
+  pow_method(std::uint64_t k, std::size_t size, std::size_t nonzeros);
+
+  /// Returns the first `size` terms of this formal power series raised to the
+  /// power of `k`, delegating to `unit_pow(q, n)` to compute the first `n`
+  /// terms of Q^k(x) for a formal power series Q(x) with Q(0) = 1. Where the
+  /// scale cannot be factored out (see `scale_out_of_range`), `bin_pow` is
+  /// used instead, reporting through `progress`.
+  template <typename UnitPow>
+  [[nodiscard]] constexpr FormalPowerSeries
+  pow_with(std::uint64_t k, std::size_t size, UnitPow unit_pow,
+           const Progress &progress = {}) const;
+
+  /// Returns the first `size` terms of Q^k(x) via the recurrence that follows
+  /// from Q(x) * (Q^k)'(x) = k * Q'(x) * Q^k(x), where Q(x) is this formal
+  /// power series. `progress`, if given, is called with the number of terms
+  /// computed at each power of two and on completion.
+  /// Precondition: this polynomial has constant term of one.
+  [[nodiscard]] constexpr FormalPowerSeries
+  unit_sparse_pow(std::uint64_t k, std::size_t size,
+                  const Progress &progress = {}) const;
 };
 
 #include "FormalPowerSeries.cpp" // Templated class, so include implementation.
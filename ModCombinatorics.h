@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <vector>
 
@@ -13,16 +14,62 @@ template <typename ModInt> struct ModCombinatorics {
   /// Computes multiplicative modualr factorials, inverse factorials, and
   /// inverses up to and including `maximum` in 'linear' time (excluding the
   /// cost of computing a stand-alone multiplicative modular inverse directly
-  /// via the implementation of `ModInt`).
+  /// via the implementation of `ModInt`, once per lane).
   explicit constexpr ModCombinatorics(std::size_t maximum)
       : n(maximum + 1), facts(n), inverse_facts(n), inverses(n) {
+    // Each factorial is one multiplication away from the one before, so a
+    // single running product is bound by the latency of multiplication. The
+    // range is instead split into LANES blocks of `width` terms, whose running
+    // products are interleaved and then joined, after the `first - 1` terms
+    // that do not divide evenly. Each i is kept as a ModInt by additions,
+    // rather than converted, which costs a reduction.
+    constexpr std::size_t LANES = 4;
+    const std::size_t width = (n - 1) / LANES;
+    const std::size_t first = n - LANES * width;
+    std::array<ModInt, LANES> factors, products;
+
     facts[0] = 1;
-    for (std::size_t i = 1; i < n; ++i) {
-      facts[i] = facts[i - 1] * i;
+    for (std::size_t i = 1; i < first; ++i) {
+      facts[i] = facts[i - 1] * ModInt(i);
+    }
+    for (std::size_t lane = 0; lane < LANES; ++lane) {
+      factors[lane] = ModInt(first + lane * width - 1);
+      products[lane] = lane == 0 ? facts[first - 1] : ModInt(1);
     }
-    inverse_facts[n - 1] = ModInt(1) / facts[n - 1]; // ModInt::inv().
-    for (std::size_t i = n - 1; i > 0; --i) {
-      inverse_facts[i - 1] = inverse_facts[i] * i;
+    for (std::size_t j = 0; j < width; ++j) {
+      for (std::size_t lane = 0; lane < LANES; ++lane) {
+        factors[lane] += ModInt(1);
+        products[lane] *= factors[lane];
+        facts[first + lane * width + j] = products[lane];
+      }
+    }
+    for (std::size_t lane = 1; lane < LANES; ++lane) {
+      const auto start = first + lane * width;
+      const auto offset = facts[start - 1];
+      for (std::size_t i = start; i < start + width; ++i) {
+        facts[i] *= offset;
+      }
+    }
+
+    // Backwards from the top of each lane, whose inverse factorial is computed
+    // directly.
+    for (std::size_t lane = 0; lane < LANES; ++lane) {
+      const auto top = first + (lane + 1) * width - 1;
+      factors[lane] = ModInt(top);
+      inverse_facts[top] = ModInt(1) / facts[top]; // ModInt::inv().
+    }
+    for (std::size_t j = 0; j < width; ++j) {
+      for (std::size_t lane = 0; lane < LANES; ++lane) {
+        const auto i = first + (lane + 1) * width - 1 - j;
+        inverse_facts[i - 1] = inverse_facts[i] * factors[lane];
+        factors[lane] -= ModInt(1);
+      }
+    }
+    for (std::size_t i = first - 1; i > 0; --i) {
+      inverse_facts[i - 1] = inverse_facts[i] * ModInt(i);
+    }
+
+    for (std::size_t i = 1; i < n; ++i) {
       inverses[i] = facts[i - 1] * inverse_facts[i];
     }
   }
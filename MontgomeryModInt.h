@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Integers modulo an odd prime P < 2^31, stored in 32 bits in Montgomery form
+/// (x * 2^32 mod P), as an opt-in alternative to ACL's modints for
+/// `FormalPowerSeries`. Addition, subtraction and multiplication are free of
+/// branches (the conditional subtraction is an unsigned minimum), so the
+/// element-wise loops of `FormalPowerSeries` can be auto-vectorised, and
+/// `montgomery_convolution` transforms coefficients without leaving Montgomery
+/// form. Conversion to and from canonical form happens only on construction
+/// from an integer and in `val()`.
+template <std::uint32_t P> class MontgomeryModInt {
+  static_assert(P % 2 == 1 && P < (1U << 31));
+
+public:
+  constexpr MontgomeryModInt() noexcept = default;
+
+  template <std::integral T>
+  constexpr MontgomeryModInt(T value) noexcept // Implicit, as in ACL.
+      : v(reduce(static_cast<std::uint64_t>(canonical(value)) * R2)) {}
+
+  static constexpr std::uint32_t mod() noexcept { return P; }
+
+  /// The canonical representative, in [0, P).
+  constexpr std::uint32_t val() const noexcept { return reduce(v); }
+
+  constexpr MontgomeryModInt &operator+=(MontgomeryModInt other) noexcept {
+    const std::uint32_t sum = v + other.v;
+    v = std::min(sum, sum - P);
+    return *this;
+  }
+
+  constexpr MontgomeryModInt &operator-=(MontgomeryModInt other) noexcept {
+    const std::uint32_t difference = v - other.v;
+    v = std::min(difference, difference + P);
+    return *this;
+  }
+
+  constexpr MontgomeryModInt &operator*=(MontgomeryModInt other) noexcept {
+    v = reduce(static_cast<std::uint64_t>(v) * other.v);
+    return *this;
+  }
+
+  constexpr MontgomeryModInt &operator/=(MontgomeryModInt other) noexcept {
+    return *this *= other.inv();
+  }
+
+  constexpr MontgomeryModInt operator+() const noexcept { return *this; }
+
+  constexpr MontgomeryModInt operator-() const noexcept {
+    return MontgomeryModInt() - *this;
+  }
+
+  constexpr MontgomeryModInt pow(std::uint64_t k) const noexcept {
+    MontgomeryModInt result(1), base = *this;
+    for (; k > 0; k >>= 1, base *= base) {
+      if (k & 1) {
+        result *= base;
+      }
+    }
+    return result;
+  }
+
+  /// The multiplicative inverse, by Fermat's little theorem. Requires P to be
+  /// prime and the value to be nonzero.
+  constexpr MontgomeryModInt inv() const noexcept {
+    assert(v != 0);
+    return pow(P - 2);
+  }
+
+  friend constexpr MontgomeryModInt operator+(MontgomeryModInt a,
+                                              MontgomeryModInt b) noexcept {
+    return a += b;
+  }
+
+  friend constexpr MontgomeryModInt operator-(MontgomeryModInt a,
+                                              MontgomeryModInt b) noexcept {
+    return a -= b;
+  }
+
+  friend constexpr MontgomeryModInt operator*(MontgomeryModInt a,
+                                              MontgomeryModInt b) noexcept {
+    return a *= b;
+  }
+
+  friend constexpr MontgomeryModInt operator/(MontgomeryModInt a,
+                                              MontgomeryModInt b) noexcept {
+    return a /= b;
+  }
+
+  // Montgomery form is a bijection on [0, P), so comparing the stored values
+  // compares the integers.
+  friend constexpr bool operator==(MontgomeryModInt a,
+                                   MontgomeryModInt b) noexcept {
+    return a.v == b.v;
+  }
+
+private:
+  // -P^{-1} mod 2^32, by Newton's iteration x <- x(2 - Px), each step doubling
+  // the number of correct low bits from the 3 that x = P already has.
+  static constexpr std::uint32_t NEG_INV = [] {
+    std::uint32_t x = P;
+    for (int i = 0; i < 4; ++i) {
+      x *= 2 - P * x;
+    }
+    return -x;
+  }();
+  static constexpr std::uint32_t R2 = [] { // 2^64 mod P.
+    const std::uint64_t r = (std::uint64_t{1} << 32) % P;
+    return static_cast<std::uint32_t>(r * r % P);
+  }();
+
+  std::uint32_t v = 0;
+
+  /// Returns t * 2^-32 mod P, in [0, P), for t < P * 2^32.
+  static constexpr std::uint32_t reduce(std::uint64_t t) noexcept {
+    const std::uint32_t m = static_cast<std::uint32_t>(t) * NEG_INV;
+    const auto u = static_cast<std::uint32_t>(
+        (t + static_cast<std::uint64_t>(m) * P) >> 32);
+    return std::min(u, u - P);
+  }
+
+  template <std::integral T>
+  static constexpr std::uint32_t canonical(T value) noexcept {
+    if constexpr (std::is_signed_v<T>) {
+      const auto r = static_cast<std::int64_t>(value) % P;
+      return static_cast<std::uint32_t>(r < 0 ? r + P : r);
+    } else {
+      return static_cast<std::uint32_t>(static_cast<std::uint64_t>(value) % P);
+    }
+  }
+};
+
+namespace montgomery_detail {
+
+// Below this operand size, schoolbook multiplication is faster than the NTT.
+inline constexpr std::size_t NAIVE_THRESHOLD = 32;
+
+/// Returns the smallest primitive root modulo the prime P.
+template <std::uint32_t P> constexpr std::uint32_t primitive_root() {
+  std::uint32_t factors[32], count = 0, rest = P - 1;
+  for (std::uint32_t f = 2; f * f <= rest; ++f) {
+    if (rest % f == 0) {
+      factors[count++] = f;
+      while (rest % f == 0) {
+        rest /= f;
+      }
+    }
+  }
+  if (rest > 1) {
+    factors[count++] = rest;
+  }
+  for (std::uint32_t g = 2;; ++g) {
+    if (std::none_of(factors, factors + count, [g](std::uint32_t f) {
+          return MontgomeryModInt<P>(g).pow((P - 1) / f) == 1;
+        })) {
+      return g;
+    }
+  }
+}
+
+/// In-place iterative radix-2 NTT of `a`, whose size is a power of two,
+/// entirely in Montgomery form. The twiddle factors of the level with
+/// butterflies of half-length h are stored contiguously at roots[h, 2h).
+template <std::uint32_t P>
+void ntt(std::vector<MontgomeryModInt<P>> &a, bool invert) {
+  using ModInt = MontgomeryModInt<P>;
+  static constexpr auto g = ModInt(primitive_root<P>());
+  const std::size_t n = a.size();
+  for (std::size_t i = 1, j = 0; i < n; ++i) {
+    std::size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(a[i], a[j]);
+    }
+  }
+  std::vector<ModInt> roots(std::max<std::size_t>(n, 2));
+  for (std::size_t half = 1; half < n; half <<= 1) {
+    const auto root = (invert ? g.inv() : g).pow((P - 1) / (2 * half));
+    roots[half] = 1;
+    for (std::size_t j = 1; j < half; ++j) {
+      roots[half + j] = roots[half + j - 1] * root;
+    }
+  }
+  for (std::size_t half = 1; half < n; half <<= 1) {
+    const ModInt *w = roots.data() + half;
+    for (std::size_t i = 0; i < n; i += 2 * half) {
+      ModInt *lo = a.data() + i, *hi = lo + half;
+      for (std::size_t j = 0; j < half; ++j) {
+        const auto u = lo[j], v = hi[j] * w[j];
+        lo[j] = u + v;
+        hi[j] = u - v;
+      }
+    }
+  }
+  if (invert) {
+    const auto n_inv = ModInt(n).inv();
+    for (auto &x : a) {
+      x *= n_inv;
+    }
+  }
+}
+
+} // namespace montgomery_detail
+
+/// Returns the product of polynomials `a` and `b` with coefficients modulo an
+/// NTT-friendly prime P, such as 998244353, by a number-theoretic transform
+/// that works on the Montgomery form directly. The product length must divide
+/// P - 1 once rounded up to a power of two.
+template <std::uint32_t P>
+std::vector<MontgomeryModInt<P>>
+montgomery_convolution(const std::vector<MontgomeryModInt<P>> &a,
+                       const std::vector<MontgomeryModInt<P>> &b) {
+  if (a.empty() || b.empty()) {
+    return {};
+  }
+  const std::size_t length = a.size() + b.size() - 1;
+  if (std::min(a.size(), b.size()) <= montgomery_detail::NAIVE_THRESHOLD) {
+    std::vector<MontgomeryModInt<P>> result(length);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      for (std::size_t j = 0; j < b.size(); ++j) {
+        result[i + j] += a[i] * b[j];
+      }
+    }
+    return result;
+  }
+  const std::size_t n = std::bit_ceil(length);
+  assert((P - 1) % n == 0);
+  auto fa = a, fb = b;
+  fa.resize(n);
+  fb.resize(n);
+  montgomery_detail::ntt(fa, false);
+  montgomery_detail::ntt(fb, false);
+  for (std::size_t k = 0; k < n; ++k) {
+    fa[k] *= fb[k];
+  }
+  montgomery_detail::ntt(fa, true);
+  fa.resize(length);
+  return fa;
+}
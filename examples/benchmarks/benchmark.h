@@ -0,0 +1,41 @@
+#pragma once
+
+// Helpers shared by the benchmarks in this directory.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+/// Returns a series of size `n` with pseudo-random coefficients, the same for
+/// every series type with the same modulus, and constant term `constant`.
+template <typename Series>
+Series sample(std::size_t n, typename Series::value_type constant) {
+  using ModInt = typename Series::value_type;
+  Series p(n);
+  unsigned long long state = 88172645463325252ULL;
+  for (auto &x : p) {
+    state ^= state << 13, state ^= state >> 7, state ^= state << 17;
+    x = ModInt(state % ModInt::mod());
+  }
+  p[0] = constant;
+  return p;
+}
+
+/// Returns the median running time of `f`, which returns a series, in
+/// milliseconds over `runs` runs. One untimed run comes first, as the first
+/// large allocations are slower (glibc maps them afresh until it raises its
+/// threshold), which would otherwise penalise whichever `f` is timed first.
+template <typename F> double time_ms(F f, int runs = 5) {
+  [[maybe_unused]] const auto warm_up = f();
+  std::vector<double> times;
+  for (int run = 0; run < runs; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    [[maybe_unused]] const auto result = f();
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    times.push_back(elapsed.count());
+  }
+  std::ranges::sort(times);
+  return times[times.size() / 2];
+}
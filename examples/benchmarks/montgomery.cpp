@@ -0,0 +1,51 @@
+// Times element-wise operations, convolution and `inverse` with ACL's modint
+// and ACL's convolution against `MontgomeryModInt` and
+// `montgomery_convolution`. Run from the `examples` directory with
+// `make bench`; an optional argument sets the size (default 2^20).
+
+#include "../../FormalPowerSeries.h"
+#include "../../MontgomeryModInt.h"
+#include "benchmark.h"
+#include <atcoder/convolution>
+#include <atcoder/modint>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+using mint = atcoder::modint998244353;
+using PowerSeries = FormalPowerSeries<mint, [](const auto &a, const auto &b) {
+  return atcoder::convolution(a, b);
+}>;
+using MontgomeryPowerSeries =
+    FormalPowerSeries<MontgomeryModInt<998244353>,
+                      [](const auto &a, const auto &b) {
+                        return montgomery_convolution(a, b);
+                      }>;
+
+int main(int argc, char *argv[]) {
+  const std::size_t n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t{1} << 20;
+  const auto p = sample<PowerSeries>(n, 1);
+  const auto q = sample<MontgomeryPowerSeries>(n, 1);
+  const auto expected = p.inverse(n / 4);
+  const auto actual = q.inverse(n / 4);
+  if (!std::ranges::equal(expected, actual, {}, &mint::val,
+                          &MontgomeryModInt<998244353>::val)) {
+    std::printf("Montgomery inverse disagrees with ACL\n");
+    return 1;
+  }
+  std::printf("%-16s%12s%12s   (n = %zu)\n", "", "ACL", "Montgomery", n);
+  const auto row = [&](const char *name, auto f, int runs) {
+    std::printf("%-16s%10.2fms%10.2fms\n", name,
+                time_ms([&] { return f(p); }, runs),
+                time_ms([&] { return f(q); }, runs));
+  };
+  row("operator+", [](const auto &s) { return s + s; }, 21);
+  row("operator-", [](const auto &s) { return s - s; }, 21);
+  row("operator*=", [](auto s) { return s *= 3; }, 21);
+  row("derivative", [](const auto &s) { return s.derivative(); }, 21);
+  row("antiderivative", [](const auto &s) { return s.antiderivative(); }, 5);
+  row("operator*", [](const auto &s) { return s * s; }, 5);
+  row("inverse", [n](const auto &s) { return s.inverse(n / 4); }, 5);
+}
@@ -0,0 +1,72 @@
+// Times `inverse` and `exp` at sizes just below and just above a power of two,
+// against the doubling schedule the library used before (precision min(2s, n)
+// at each step), which nearly doubles the cost of sizes just above a power of
+// two. Run from the `examples` directory with `make bench`; an optional
+// argument sets the power of two (default 2^18).
+
+#include "../../Convolutions.h"
+#include "../../FormalPowerSeries.h"
+#include "benchmark.h"
+#include <atcoder/convolution>
+#include <atcoder/modint>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using mint = atcoder::modint998244353;
+constexpr auto ntt = [](const auto &a, const auto &b) {
+  return atcoder::convolution(a, b);
+};
+using PowerSeries = FormalPowerSeries<mint, ntt>;
+using SplitPowerSeries =
+    FormalPowerSeries<mint, [](const auto &a, const auto &b) {
+      return split_convolution<mint, ntt>(a, b);
+    }>;
+
+// The inverse as computed before the precision schedule was introduced.
+PowerSeries doubling_inverse(const PowerSeries &p, std::size_t n) {
+  PowerSeries res{p[0].inv()};
+  while (res.size() != n) {
+    const auto next_size = std::min(res.size() * 2, n);
+    res = (res * (PowerSeries{mint(2)} - p.take(next_size) * res))
+              .take(next_size);
+  }
+  return res;
+}
+
+int main(int argc, char *argv[]) {
+  const int log_n = argc > 1 ? std::atoi(argv[1]) : 18;
+  const std::size_t sizes[] = {(std::size_t{1} << log_n) - 1,
+                               std::size_t{1} << log_n,
+                               (std::size_t{1} << log_n) + 1};
+  std::printf("%-26s", "size");
+  for (const auto n : sizes) {
+    std::printf("%12zu", n);
+  }
+  std::printf("\n");
+  const auto row = [&](const std::string &name, auto run) {
+    std::printf("%-26s", name.c_str());
+    for (const auto n : sizes) {
+      std::printf("%10.1fms", time_ms([&] { return run(n); }));
+    }
+    std::printf("\n");
+  };
+
+  const auto p = sample<PowerSeries>(sizes[2], mint(1));
+  const auto q = sample<SplitPowerSeries>(sizes[2], mint(1));
+  const auto p0 = sample<PowerSeries>(sizes[2], mint(0));
+  const auto q0 = sample<SplitPowerSeries>(sizes[2], mint(0));
+  if (doubling_inverse(p, sizes[2]) != p.inverse(sizes[2])) {
+    std::printf("inverse disagrees with the doubling baseline\n");
+    return 1;
+  }
+  row("inverse, doubling",
+      [&](std::size_t n) { return doubling_inverse(p, n); });
+  row("inverse", [&](std::size_t n) { return p.inverse(n); });
+  row("inverse, split_convolution",
+      [&](std::size_t n) { return q.inverse(n); });
+  row("exp", [&](std::size_t n) { return p0.exp(n); });
+  row("exp, split_convolution", [&](std::size_t n) { return q0.exp(n); });
+}
@@ -0,0 +1,43 @@
+// Times a raw product with ACL's convolution against `split_convolution` for
+// product lengths L at and above a power of two N, where ACL's convolution pads
+// its transforms to length 2N. Run from the `examples` directory with `make
+// bench`; an optional argument sets the power of two (default 2^20).
+
+#include "../../Convolutions.h"
+#include "../../FormalPowerSeries.h"
+#include "benchmark.h"
+#include <atcoder/convolution>
+#include <atcoder/modint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+using mint = atcoder::modint998244353;
+constexpr auto ntt = [](const auto &a, const auto &b) {
+  return atcoder::convolution(a, b);
+};
+using PowerSeries = FormalPowerSeries<mint, ntt>;
+
+int main(int argc, char *argv[]) {
+  const int log_n = argc > 1 ? std::atoi(argv[1]) : 20;
+  const std::size_t n = std::size_t{1} << log_n;
+  std::printf("%-12s%12s%12s%20s\n", "L / N", "L", "ACL",
+              "split_convolution");
+  for (const std::size_t length : {n - 1, n + 1, n + n / 1000, n + n / 100,
+                                   n + n / 20, n + n / 10, n + n / 4,
+                                   n + n / 2}) {
+    // Operands of equal size, for a product of length L = `length`, rounded
+    // up to an odd number.
+    const auto half = length / 2 + 1;
+    const auto a = sample<PowerSeries>(half, 1);
+    const auto b = sample<PowerSeries>(half, 2);
+    if (ntt(a, b) != split_convolution<mint, ntt>(a, b)) {
+      std::printf("split_convolution disagrees with ACL\n");
+      return 1;
+    }
+    std::printf("%-12.4f%12zu%10.1fms%18.1fms\n",
+                static_cast<double>(2 * half - 1) / n, 2 * half - 1,
+                time_ms([&] { return ntt(a, b); }),
+                time_ms([&] { return split_convolution<mint, ntt>(a, b); }));
+  }
+}
@@ -1,9 +1,9 @@
 // https://judge.yosupo.jp/problem/log_of_formal_power_series
 
+#include "../../FastIO.h"
 #include "../../FormalPowerSeries.h"
 #include <atcoder/convolution>
 #include <atcoder/modint>
-#include <iostream>
 
 using mint = atcoder::modint998244353;
 using PowerSeries = FormalPowerSeries<mint, [](const auto &a, const auto &b) {
@@ -11,20 +11,18 @@ using PowerSeries = FormalPowerSeries<mint, [](const auto &a, const auto &b) {
 }>;
 
 int main() {
-  std::ios::sync_with_stdio(false);
-  std::cin.tie(nullptr);
+  FastInput in;
+  FastOutput out;
 
-  int n;
-  std::cin >> n;
+  const auto n = in.read<int>();
 
   PowerSeries a(n);
   for (int i = 0; i < n; ++i) {
-    int x;
-    std::cin >> x;
-    a[i] = x;
+    a[i] = in.read<int>();
   }
 
   for (const auto &x : a.log(n)) {
-    std::cout << x.val() << ' ';
+    out.write(x.val());
+    out.write(' ');
   }
 }
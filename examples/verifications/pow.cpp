@@ -1,10 +1,10 @@
 // https://judge.yosupo.jp/problem/pow_of_formal_power_series
 
+#include "../../FastIO.h"
 #include "../../FormalPowerSeries.h"
 #include <atcoder/convolution>
 #include <atcoder/modint>
 #include <cstdint>
-#include <iostream>
 
 using mint = atcoder::modint998244353;
 using PowerSeries = FormalPowerSeries<mint, [](const auto &a, const auto &b) {
@@ -12,21 +12,19 @@ using PowerSeries = FormalPowerSeries<mint, [](const auto &a, const auto &b) {
 }>;
 
 int main() {
-  std::ios::sync_with_stdio(false);
-  std::cin.tie(nullptr);
+  FastInput in;
+  FastOutput out;
 
-  int n;
-  std::int64_t m;
-  std::cin >> n >> m;
+  const auto n = in.read<int>();
+  const auto m = in.read<std::int64_t>();
 
   PowerSeries a(n);
   for (int i = 0; i < n; ++i) {
-    int x;
-    std::cin >> x;
-    a[i] = x;
+    a[i] = in.read<int>();
   }
 
   for (const auto &x : a.pow(m, n)) {
-    std::cout << x.val() << ' ';
+    out.write(x.val());
+    out.write(' ');
   }
 }
@@ -1,15 +1,28 @@
+#include "Convolutions.h"
+#include "FFTConvolution.h"
+#include "FastIO.h"
 #include "FormalPowerSeries.h"
+#include "MontgomeryModInt.h"
+#include <algorithm>
 #include <atcoder/convolution>
 #include <atcoder/modint>
+#include <cmath>
+#include <complex>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
 #include <gtest/gtest.h>
+#include <limits>
 #include <ostream>
+#include <utility>
 #include <vector>
 
 using mint = atcoder::modint998244353;
-using PowerSeries = FormalPowerSeries<mint, [](const auto &a, const auto &b) {
+constexpr auto ntt = [](const auto &a, const auto &b) {
   return atcoder::convolution(a, b);
-}>;
+};
+using PowerSeries = FormalPowerSeries<mint, ntt>;
 
 class FormalPowerSeriesTest : public ::testing::Test {
 protected:
@@ -19,6 +32,52 @@ protected:
       EXPECT_EQ(p[i], expected[i]);
     }
   }
+
+  // A dense and a sparse series, neither with a constant term of one, for
+  // comparing the methods of raising to a power.
+  const PowerSeries dense = [] {
+    PowerSeries p(300);
+    for (std::size_t i = 0; i < p.size(); ++i) {
+      p[i] = mint(i * 7 + 3);
+    }
+    return p;
+  }();
+  const PowerSeries sparse = [] {
+    PowerSeries p(300);
+    p[0] = 5, p[1] = 2, p[40] = 9;
+    return p;
+  }();
+
+  // Operands of size `n` with coefficients i^2 + c and 3i + 2, for comparing
+  // products and other operations against a reference.
+  template <typename Series = PowerSeries>
+  static Series quadratic(std::size_t n, int c = 1) {
+    using ModInt = typename Series::value_type;
+    Series p(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      p[i] = ModInt(i * i) + ModInt(c);
+    }
+    return p;
+  }
+  static PowerSeries linear(std::size_t n) {
+    PowerSeries p(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      p[i] = mint(3 * i + 2);
+    }
+    return p;
+  }
+
+  // Cancels an operation once 8 or more terms are known.
+  static bool until_eight(std::size_t done, std::size_t) { return done < 8; }
+
+  // Checks that progress reports strictly increase up to `total`.
+  void check_reports(const std::vector<std::size_t> &reported,
+                     std::size_t total) {
+    ASSERT_FALSE(reported.empty());
+    EXPECT_TRUE(std::ranges::adjacent_find(reported, std::greater_equal{}) ==
+                reported.end());
+    EXPECT_EQ(reported.back(), total);
+  }
 };
 
 TEST_F(FormalPowerSeriesTest, Constructors) {
@@ -69,6 +128,21 @@ TEST_F(FormalPowerSeriesTest, Antiderivative) {
 
   PowerSeries empty;
   check_content(empty.antiderivative(), {0});
+
+  PowerSeries q{5, 0, 7, 1, 2, 9, 4, 4};
+  check_content(q.antiderivative().derivative(), q);
+
+  // Sizes on either side of each split of the factorials into lanes.
+  for (std::size_t maximum = 0; maximum < 20; ++maximum) {
+    const ModCombinatorics<mint> combinatorics(maximum);
+    mint fact = 1;
+    for (std::size_t i = 0; i <= maximum; ++i) {
+      fact *= std::max<std::size_t>(i, 1);
+      EXPECT_EQ(combinatorics.facts[i], fact);
+      EXPECT_EQ(combinatorics.inverse_facts[i] * fact, mint(1));
+      EXPECT_EQ(combinatorics.inverses[i] * i, mint(i != 0));
+    }
+  }
 }
 
 TEST_F(FormalPowerSeriesTest, BasicArithmetic) {
@@ -90,6 +164,88 @@ TEST_F(FormalPowerSeriesTest, Multiplication) {
   check_content(p * q, {3, 10, 13, 10});
 }
 
+TEST_F(FormalPowerSeriesTest, BlockConvolution) {
+  const std::vector<mint> a = quadratic(100), b = linear(37);
+  const auto expected = atcoder::convolution(a, b);
+  for (const std::size_t block_size : {1, 7, 37, 64, 200}) {
+    check_content(PowerSeries(block_convolution<mint, ntt>(a, b, block_size)),
+                  expected);
+  }
+  check_content(PowerSeries(block_convolution<mint, ntt>(a, {}, 8)), {});
+}
+
+TEST_F(FormalPowerSeriesTest, StreamConvolution) {
+  const std::vector<mint> a = quadratic(1000), b = linear(700);
+  std::FILE *a_file = std::tmpfile(), *b_file = std::tmpfile(),
+            *result_file = std::tmpfile();
+  ASSERT_TRUE(write_binary(a_file, a));
+  ASSERT_TRUE(write_binary(b_file, b));
+  std::rewind(a_file);
+  std::rewind(b_file);
+  const auto read_a = BinarySeriesReader<mint>::open(a_file);
+  const auto read_b = BinarySeriesReader<mint>::open(b_file);
+  ASSERT_TRUE(read_a && read_b);
+  const std::size_t length = a.size() + b.size() - 1;
+  auto sink = BinarySeriesWriter<mint>::open(result_file, length);
+  ASSERT_TRUE(sink);
+  std::size_t blocks = 0;
+  EXPECT_TRUE((stream_convolution<mint, ntt>(
+      read_a->size(),
+      [&](std::size_t offset, std::size_t count) {
+        return read_a->read(offset, count);
+      },
+      read_b->size(),
+      [&](std::size_t offset, std::size_t count) {
+        return read_b->read(offset, count);
+      },
+      [&](const std::vector<mint> &block) {
+        EXPECT_EQ(block.size(),
+                  std::min<std::size_t>(64, length - 64 * blocks));
+        ++blocks;
+        return (*sink)(block);
+      },
+      64)));
+  EXPECT_EQ(blocks, (length + 63) / 64);
+  std::rewind(result_file);
+  const auto result = read_binary<PowerSeries>(result_file);
+  ASSERT_TRUE(result.has_value());
+  check_content(*result, atcoder::convolution(a, b));
+
+  // A short read of either operand, or a rejected block, stops the product.
+  const auto from = [](const std::vector<mint> &v, std::size_t limit) {
+    return [&v, limit](std::size_t offset, std::size_t count) {
+      return std::vector<mint>(v.begin() + std::min(offset, limit),
+                               v.begin() + std::min(offset + count, limit));
+    };
+  };
+  const auto accept = [](const std::vector<mint> &) { return true; };
+  EXPECT_FALSE((stream_convolution<mint, ntt>(
+      a.size(), from(a, 999), b.size(), from(b, b.size()), accept, 64)));
+  EXPECT_FALSE((stream_convolution<mint, ntt>(
+      a.size(), from(a, a.size()), b.size(), from(b, 100), accept, 64)));
+  EXPECT_FALSE((stream_convolution<mint, ntt>(
+      a.size(), from(a, a.size()), b.size(), from(b, b.size()),
+      [](const std::vector<mint> &) { return false; }, 64)));
+  std::fclose(a_file);
+  std::fclose(b_file);
+  std::fclose(result_file);
+}
+
+TEST_F(FormalPowerSeriesTest, SplitConvolution) {
+  // Product lengths just above, at, and well above a power of two.
+  for (const auto &[n, m] : {std::pair<std::size_t, std::size_t>{600, 430},
+                             {430, 600},
+                             {1024, 2},
+                             {600, 425},
+                             {700, 700},
+                             {3, 5}}) {
+    const std::vector<mint> a = quadratic(n), b = linear(m);
+    check_content(PowerSeries(split_convolution<mint, ntt>(a, b)),
+                  atcoder::convolution(a, b));
+  }
+  check_content(PowerSeries(split_convolution<mint, ntt>({}, {1, 2})), {});
+}
+
 TEST_F(FormalPowerSeriesTest, LogPrecondition) {
   PowerSeries valid{1, 2, 3};
   EXPECT_NO_THROW(valid.log(3));
@@ -129,6 +285,115 @@ TEST_F(FormalPowerSeriesTest, MultIdentity) {
   check_content(PowerSeries::mult_identity(3), {1, 0, 0});
 }
 
+TEST_F(FormalPowerSeriesTest, ProductOf) {
+  check_content(PowerSeries::product_of(std::vector<PowerSeries>{}), {1});
+  check_content(PowerSeries::product_of(std::vector<PowerSeries>{{1, 2}}),
+                {1, 2});
+
+  // (1 + x)(1 + 2x + x^2)(3)(1 - x) = 3 + 6x - 6x^3 - 3x^4.
+  std::vector<PowerSeries> factors = {{1, 1}, {1, 2, 1}, {3}, {1, -1}};
+  check_content(PowerSeries::product_of(factors), {3, 6, 0, -6, -3});
+
+  // Falling factorial x(x - 1)(x - 2)(x - 3), i.e. signed Stirling numbers.
+  std::vector<PowerSeries> linear;
+  for (int i = 0; i < 4; ++i) {
+    linear.push_back({-i, 1});
+  }
+  check_content(PowerSeries::product_of(linear), {0, -6, 11, -6, 1});
+
+  // Moving the factors in hands over their coefficients rather than copying
+  // them, leaving the caller's factors empty.
+  check_content(PowerSeries::product_of(std::move(linear)),
+                {0, -6, 11, -6, 1});
+  for (const auto &factor : linear) {
+    EXPECT_TRUE(factor.empty());
+  }
+}
+
+TEST_F(FormalPowerSeriesTest, EvaluateGeometric) {
+  PowerSeries p{1, 2, 3};
+  // 1 + 2x + 3x^2 at x = 3, 6, 12, 24.
+  check_content(PowerSeries(p.evaluate_geometric(3, 2, 4)),
+                {34, 121, 457, 1777});
+  check_content(PowerSeries(p.evaluate_geometric(3, 2, 0)), {});
+  check_content(PowerSeries(PowerSeries{}.evaluate_geometric(3, 2, 2)),
+                {0, 0});
+
+  const auto q = quadratic(50, 5);
+  const mint a = 7, r = 11;
+  const auto values = q.evaluate_geometric(a, r, 80);
+  mint x = a;
+  for (std::size_t i = 0; i < values.size(); ++i, x *= r) {
+    mint expected = 0;
+    for (std::size_t j = q.size(); j-- > 0;) {
+      expected = expected * x + q[j];
+    }
+    EXPECT_EQ(values[i], expected);
+  }
+}
+
+TEST_F(FormalPowerSeriesTest, InterpolateGeometric) {
+  PowerSeries p{1, 2, 3};
+  check_content(PowerSeries::interpolate_geometric(3, 2, {34, 121, 457}), p);
+  check_content(PowerSeries::interpolate_geometric(3, 2, {}), {});
+  check_content(PowerSeries::interpolate_geometric(3, 2, {5}), {5});
+
+  const auto q = quadratic(64, 5);
+  check_content(PowerSeries::interpolate_geometric(
+                    7, 11, q.evaluate_geometric(7, 11, q.size())),
+                q);
+
+  // Evaluation at the 64th roots of unity is a DFT, where r^64 = 1.
+  const mint root = mint(3).pow((mint::mod() - 1) / 64);
+  check_content(PowerSeries::interpolate_geometric(
+                    1, root, q.evaluate_geometric(1, root, q.size())),
+                q);
+}
+
+TEST_F(FormalPowerSeriesTest, SolveNewton) {
+  // T(x) = x * e^{T(x)} has [x^n] T(x) = n^{n-1} / n!.
+  const auto tree = PowerSeries::solve_newton(
+      [](const PowerSeries &t, std::size_t n) {
+        return t - PowerSeries{0, 1} * t.exp(n);
+      },
+      [](const PowerSeries &t, std::size_t n) {
+        return PowerSeries{1} - PowerSeries{0, 1} * t.exp(n);
+      },
+      {0}, 20);
+  ASSERT_EQ(tree.size(), 20u);
+  mint factorial = 1;
+  for (std::size_t i = 1; i < tree.size(); ++i) {
+    factorial *= i;
+    EXPECT_EQ(tree[i], mint(i).pow(i - 1) / factorial);
+  }
+
+  // Y^2 = 1 + 4x, resumed from a longer prefix.
+  const auto square = [](const PowerSeries &y, std::size_t n) {
+    return (y * y).take(n) - PowerSeries{1, 4};
+  };
+  const auto twice = [](const PowerSeries &y, std::size_t n) {
+    return (y * mint(2)).take(n);
+  };
+  const auto root = PowerSeries::solve_newton(square, twice, {1}, 10);
+  check_content((root * root).take(10), PowerSeries{1, 4}.take(10));
+  check_content(PowerSeries::solve_newton(square, twice, root.take(3), 10),
+                root);
+}
+
+TEST_F(FormalPowerSeriesTest, SolveLinearOde) {
+  // Y' = Y with Y(0) = 1 is e^x.
+  check_content(PowerSeries::solve_linear_ode({1}, {}, 1, 5),
+                PowerSeries{0, 1}.exp(5));
+  check_content(PowerSeries::solve_linear_ode({1}, {}, 1, 0), {});
+  check_content(PowerSeries::solve_linear_ode({1}, {}, 3, 1), {3});
+
+  const PowerSeries a{2, 0, 5, 1}, b{7, 1, 1, 3, 9};
+  const auto y = PowerSeries::solve_linear_ode(a, b, 4, 12);
+  ASSERT_EQ(y.size(), 12u);
+  EXPECT_EQ(y[0], mint(4));
+  check_content(y.derivative(), (a * y + b).take(11));
+}
+
 TEST_F(FormalPowerSeriesTest, InverseSamples) {
   PowerSeries p{5, 4, 3, 2, 1};
   check_content(p.inverse(5),
@@ -146,6 +411,62 @@ TEST_F(FormalPowerSeriesTest, ExpSamples) {
   check_content(p.exp(0), {});
 }
 
+TEST_F(FormalPowerSeriesTest, ResumedInverse) {
+  PowerSeries p{5, 4, 3, 2, 1};
+  const auto expected = p.inverse(9);
+  for (std::size_t prefix_size = 1; prefix_size <= 9; ++prefix_size) {
+    check_content(p.inverse(9, p.inverse(prefix_size)), expected);
+  }
+  check_content(p.inverse(3, expected), expected.take(3));
+
+  PowerSeries empty;
+  EXPECT_DEATH(p.inverse(3, empty), "");
+}
+
+TEST_F(FormalPowerSeriesTest, ResumedExp) {
+  PowerSeries p{0, 1, 2, 3, 4};
+  const auto expected = p.exp(9);
+  for (std::size_t prefix_size = 1; prefix_size <= 9; ++prefix_size) {
+    check_content(p.exp(9, p.exp(prefix_size)), expected);
+  }
+  check_content(p.exp(3, expected), expected.take(3));
+
+  PowerSeries empty;
+  EXPECT_DEATH(p.exp(3, empty), "");
+}
+
+TEST_F(FormalPowerSeriesTest, Progress) {
+  const auto p = quadratic(100);
+  std::vector<std::size_t> reported;
+  const auto expected = p.inverse(100);
+  check_content(p.inverse(100,
+                          [&](std::size_t done, std::size_t total) {
+                            EXPECT_EQ(total, 100u);
+                            reported.push_back(done);
+                            return true;
+                          }),
+                expected);
+  check_reports(reported, 100);
+
+  // Cancelling once 8 terms are known returns a prefix, which can be resumed.
+  const auto partial = p.inverse(100, until_eight);
+  ASSERT_GE(partial.size(), 8u);
+  ASSERT_LT(partial.size(), 100u);
+  check_content(partial, expected.take(partial.size()));
+  check_content(p.inverse(100, partial), expected);
+
+  const auto q = p.inverse(100) * mint(-1) + PowerSeries{1};
+  const auto exp = q.exp(100);
+  const auto partial_exp = q.exp(100, until_eight);
+  ASSERT_LT(partial_exp.size(), 100u);
+  check_content(partial_exp, exp.take(partial_exp.size()));
+
+  const auto log = p.log(100);
+  const auto partial_log = p.log(100, until_eight);
+  ASSERT_LT(partial_log.size(), 100u);
+  check_content(partial_log, log.take(partial_log.size()));
+}
+
 TEST_F(FormalPowerSeriesTest, LogSamples) {
   PowerSeries p{1, 1, 499122179, 166374064, 291154613};
   check_content(p.log(5), {0, 1, 2, 3, 4});
@@ -154,6 +475,84 @@ TEST_F(FormalPowerSeriesTest, LogSamples) {
   check_content(p.log(0), {});
 }
 
+TEST_F(FormalPowerSeriesTest, PowProgress) {
+  for (const auto &p : {dense, sparse}) {
+    const auto expected = p.pow(123456789, 300);
+    std::vector<std::size_t> reported;
+    std::size_t reported_total = 0;
+    check_content(p.pow(123456789, 300,
+                        [&](std::size_t done, std::size_t total) {
+                          reported_total = total;
+                          reported.push_back(done);
+                          return true;
+                        }),
+                  expected);
+    check_reports(reported, reported_total);
+
+    const auto partial = p.pow(123456789, 300, until_eight);
+    ASSERT_LT(partial.size(), 300u);
+    check_content(partial, expected.take(partial.size()));
+  }
+
+  // Cancelling on the last report of `log` still cancels `pow`.
+  const auto partial = dense.pow(123456789, 300,
+                                 [](std::size_t done, std::size_t total) {
+                                   return done != total / 2;
+                                 });
+  ASSERT_LT(partial.size(), 300u);
+
+  // For a small exponent, `pow` takes `bin_pow`, which reports each product.
+  const std::size_t size = 1 << 12;
+  std::vector<std::size_t> reported;
+  std::size_t reported_total = 0;
+  check_content(dense.pow(100, size,
+                          [&](std::size_t done, std::size_t total) {
+                            reported_total = total;
+                            reported.push_back(done);
+                            return true;
+                          }),
+                dense.bin_pow(100, size));
+  check_reports(reported, reported_total);
+  EXPECT_EQ(reported_total, 8u); // 6 squarings and 2 multiplications.
+  const auto cancelled =
+      dense.pow(100, size, [](std::size_t, std::size_t) { return false; });
+  check_content(cancelled, dense.bin_pow(100, 1));
+}
+
+TEST_F(FormalPowerSeriesTest, PowMethodsAgree) {
+  for (const auto &p : {dense, sparse}) {
+    for (const std::uint64_t k : {1, 2, 3, 1000, 123456789}) {
+      const auto expected = p.bin_pow(k, 500);
+      check_content(p.pow(k, 500), expected);
+      check_content(p.sparse_pow(k, 500), expected);
+      EXPECT_EQ(p.pow_coefficient(k, 499), expected.back());
+    }
+  }
+}
+
+TEST_F(FormalPowerSeriesTest, PowCoefficient) {
+  // `sparse` and `shifted` take the sparse recurrence, across its windows of
+  // inverses, while `dense` falls back to `pow`.
+  PowerSeries shifted(20001);
+  shifted[2] = 4, shifted[3] = 1, shifted[9] = 6;
+  for (const auto &p : {dense, sparse, shifted}) {
+    for (const std::uint64_t k : {1, 2, 5, 123456789}) {
+      const auto expected = p.pow(k, 20001);
+      for (const std::size_t n : {0, 1, 9, 1023, 1024, 1025, 20000}) {
+        EXPECT_EQ(p.pow_coefficient(k, n), expected[n]);
+      }
+    }
+  }
+  EXPECT_EQ(shifted.pow_coefficient(0, 0), mint(1));
+  EXPECT_EQ(shifted.pow_coefficient(0, 5), mint(0));
+  EXPECT_EQ(PowerSeries(10).pow_coefficient(3, 5), mint(0));
+  EXPECT_EQ(PowerSeries({0, 1}).pow_coefficient(5, 4), mint(0));
+  // The series may stop well before x^n.
+  const PowerSeries trinomial{1, 1, 1};
+  EXPECT_EQ(trinomial.pow_coefficient(30000, 30000),
+            trinomial.bin_pow(30000, 30001).back());
+}
+
 // To reduce duplication between testing `FormalPowerSeries::pow` and
 // `FormalPowerSeries::bin_pow`, we use a value-parameterized test suite.
 struct PowerMethodParam {
@@ -205,6 +604,24 @@ TEST_P(FormalPowerSeriesPowerTest, ZeroBaseEdgeCases) {
   check_content(power(empty, 2, 3), {0, 0, 0});
 }
 
+TEST_P(FormalPowerSeriesPowerTest, ExponentsBeyondModulus) {
+  // (1 + x)^p = 1 + x^p (mod p), so (1 + x)^{p + 2} = (1 + x)^2 (mod x^3).
+  const std::uint64_t p = mint::mod();
+  check_content(power(PowerSeries{1, 1}, p + 2, 3), {1, 2, 1});
+
+  // (2 + 4x)^k = 2^k * (1 + 2kx + ...), for the largest k.
+  const std::uint64_t k = std::numeric_limits<std::uint64_t>::max();
+  const mint scale = mint(2).pow(k % (p - 1));
+  check_content(power(PowerSeries{2, 4}, k, 2), {scale, scale * 2 * mint(k)});
+}
+
+TEST_P(FormalPowerSeriesPowerTest, SparseSamples) {
+  // (1 + x^3)^4 = 1 + 4x^3 + 6x^6 + 4x^9 + x^12.
+  PowerSeries p(8);
+  p[0] = 1, p[3] = 1;
+  check_content(power(p, 4, 10), {1, 0, 0, 4, 0, 0, 6, 0, 0, 4});
+}
+
 INSTANTIATE_TEST_SUITE_P(
     PowerMethods, FormalPowerSeriesPowerTest,
     ::testing::Values(
@@ -213,4 +630,330 @@ INSTANTIATE_TEST_SUITE_P(
                          "Pow"},
         PowerMethodParam{[](const PowerSeries &p, std::uint64_t n,
                             std::size_t deg) { return p.bin_pow(n, deg); },
-                         "BinPow"}));
\ No newline at end of file
+                         "BinPow"},
+        PowerMethodParam{[](const PowerSeries &p, std::uint64_t n,
+                            std::size_t deg) { return p.sparse_pow(n, deg); },
+                         "SparsePow"}));
+
+using RealPowerSeries =
+    FormalPowerSeries<double, [](const auto &a, const auto &b) {
+      return fft_convolution(a, b);
+    }>;
+
+class RealFormalPowerSeriesTest : public ::testing::Test {
+protected:
+  static constexpr double tolerance = 1e-9;
+
+  void check_content(const std::vector<double> &p,
+                     const std::vector<double> &expected) {
+    ASSERT_EQ(p.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR(p[i], expected[i], tolerance);
+    }
+  }
+};
+
+TEST_F(RealFormalPowerSeriesTest, FFTConvolution) {
+  std::vector<double> a(300), b(200);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    a[i] = std::sin(i * 0.7);
+  }
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    b[i] = std::cos(i * 1.3);
+  }
+  check_content(fft_convolution(a, b), fft_detail::naive_convolution(a, b));
+  check_content(fft_convolution(std::vector<double>{1, 2}, {3, 4, 5}),
+                {3, 10, 13, 10});
+  check_content(fft_convolution(a, {}), {});
+
+  std::vector<std::complex<double>> c(100), d(100);
+  for (std::size_t i = 0; i < c.size(); ++i) {
+    c[i] = {std::sin(i * 0.3), std::cos(i * 0.2)};
+    d[i] = {1.0 / (i + 1), -0.5};
+  }
+  const auto product = fft_convolution(c, d);
+  const auto expected = fft_detail::naive_convolution(c, d);
+  ASSERT_EQ(product.size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(std::abs(product[i] - expected[i]), 0, tolerance);
+  }
+}
+
+TEST_F(RealFormalPowerSeriesTest, FFTErrorBound) {
+  // Multiples of 2^-10 of at most 1 in magnitude, so that the naive product,
+  // with at most 2^12 terms per coefficient, is exact in double precision.
+  // The scale of `a` checks operands of very different norms.
+  std::vector<double> a(4096), b(3000);
+  std::vector<std::complex<double>> c(4096), d(3000);
+  unsigned state = 12345;
+  const auto next = [&state] {
+    state = state * 1103515245 + 12345;
+    return std::ldexp(static_cast<int>(state >> 16) % 1025, -10);
+  };
+  for (const int scale : {0, 30}) {
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      a[i] = std::ldexp(next(), scale);
+      c[i] = {next(), -next()};
+    }
+    for (std::size_t i = 0; i < b.size(); ++i) {
+      b[i] = -next();
+      d[i] = {next(), next()};
+    }
+    const auto real = fft_convolution(a, b);
+    const auto real_exact = fft_detail::naive_convolution(a, b);
+    const auto complex = fft_convolution(c, d);
+    const auto complex_exact = fft_detail::naive_convolution(c, d);
+    double real_error = 0, complex_error = 0;
+    for (std::size_t i = 0; i < real.size(); ++i) {
+      real_error = std::max(real_error, std::abs(real[i] - real_exact[i]));
+      complex_error =
+          std::max(complex_error, std::abs(complex[i] - complex_exact[i]));
+    }
+    EXPECT_GT(real_error, 0);
+    EXPECT_LE(real_error, fft_error_bound(a, b));
+    EXPECT_GT(complex_error, 0);
+    EXPECT_LE(complex_error, fft_error_bound(c, d));
+  }
+  EXPECT_EQ(fft_error_bound(a, {}), 0);
+}
+
+TEST_F(RealFormalPowerSeriesTest, Operations) {
+  // 1 / (1 - x) = 1 + x + x^2 + ...
+  check_content(RealPowerSeries{1, -1}.inverse(200),
+                std::vector<double>(200, 1));
+
+  // e^x = sum x^i / i!, and ln(e^x) = x.
+  const auto exp = RealPowerSeries{0, 1}.exp(100);
+  std::vector<double> expected(100);
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = 1.0 / std::tgamma(i + 1.0);
+  }
+  check_content(exp, expected);
+  check_content(exp.log(100), RealPowerSeries{0, 1}.take(100));
+
+  // The sum of 10 fair coin flips is binomially distributed.
+  const auto sum = RealPowerSeries{0.5, 0.5}.pow(10, 11);
+  for (std::size_t i = 0; i <= 10; ++i) {
+    EXPECT_NEAR(sum[i],
+                std::tgamma(11.0) / std::tgamma(i + 1.0) /
+                    std::tgamma(11.0 - i) / 1024,
+                tolerance);
+  }
+}
+
+TEST_F(RealFormalPowerSeriesTest, LargePowers) {
+  // The sum of 2000 coin flips, where 2^-2000 and the binomial coefficients
+  // are each out of range, but their products are not.
+  const std::size_t flips = 2000;
+  const auto flips_sum = RealPowerSeries{0.5, 0.5}.pow(flips, flips + 1);
+  ASSERT_EQ(flips_sum.size(), flips + 1);
+  for (std::size_t i = 0; i <= flips; ++i) {
+    const double n = flips;
+    EXPECT_NEAR(flips_sum[i],
+                std::exp(std::lgamma(n + 1) - std::lgamma(i + 1.0) -
+                         std::lgamma(n - i + 1) - n * std::log(2.0)),
+                tolerance);
+  }
+
+  // The sum of 400 rolls of a die, faces 1 to 6, has mean 400 * 7/2 and
+  // variance 400 * 35/12.
+  const std::size_t rolls = 400;
+  RealPowerSeries die(7, 1.0 / 6);
+  die[0] = 0;
+  for (const auto &sum : {die.pow(rolls, 6 * rolls + 1),
+                          die.sparse_pow(rolls, 6 * rolls + 1)}) {
+    double total = 0, mean = 0, square = 0;
+    for (std::size_t i = 0; i < sum.size(); ++i) {
+      ASSERT_TRUE(std::isfinite(sum[i]));
+      total += sum[i];
+      mean += i * sum[i];
+      square += i * i * sum[i];
+    }
+    EXPECT_NEAR(total, 1, tolerance);
+    EXPECT_NEAR(mean, rolls * 3.5, 1e-6);
+    EXPECT_NEAR(square - mean * mean, rolls * 35.0 / 12, 1e-6);
+  }
+  EXPECT_NEAR(die.pow_coefficient(rolls, 1400),
+              die.bin_pow(rolls, 1401).back(), tolerance);
+}
+
+using MontgomeryInt = MontgomeryModInt<998244353>;
+using MontgomeryPowerSeries =
+    FormalPowerSeries<MontgomeryInt, [](const auto &a, const auto &b) {
+      return montgomery_convolution(a, b);
+    }>;
+
+class MontgomeryFormalPowerSeriesTest : public FormalPowerSeriesTest {
+protected:
+  static PowerSeries canonical(const MontgomeryPowerSeries &p) {
+    PowerSeries result(p.size());
+    for (std::size_t i = 0; i < p.size(); ++i) {
+      result[i] = p[i].val();
+    }
+    return result;
+  }
+};
+
+TEST_F(MontgomeryFormalPowerSeriesTest, Arithmetic) {
+  // Values around zero and the modulus, where the branch-free reductions wrap.
+  const std::int64_t p = MontgomeryInt::mod();
+  const std::vector<std::int64_t> values{
+      0, 1, 2, p - 2, p - 1, p, p + 1, 2 * p - 1, -1, -p, -p - 1,
+      123456789123456789LL, std::numeric_limits<std::int64_t>::min()};
+  for (const auto x : values) {
+    EXPECT_EQ(MontgomeryInt(x).val(), mint(x).val());
+    EXPECT_EQ((-MontgomeryInt(x)).val(), (-mint(x)).val());
+    for (const auto y : values) {
+      const MontgomeryInt a(x), b(y);
+      EXPECT_EQ((a + b).val(), (mint(x) + mint(y)).val());
+      EXPECT_EQ((a - b).val(), (mint(x) - mint(y)).val());
+      EXPECT_EQ((a * b).val(), (mint(x) * mint(y)).val());
+      EXPECT_EQ(a == b, mint(x) == mint(y));
+      if (b != MontgomeryInt(0)) {
+        EXPECT_EQ((a / b).val(), (mint(x) / mint(y)).val());
+      }
+    }
+  }
+  EXPECT_EQ(MontgomeryInt(std::numeric_limits<std::uint64_t>::max()).val(),
+            mint(std::numeric_limits<std::uint64_t>::max()).val());
+  EXPECT_EQ(MontgomeryModInt<1000000007>(-1).val(), 1000000006U);
+  EXPECT_EQ(MontgomeryModInt<1000000007>(2).pow(1000000006).val(), 1U);
+}
+
+TEST_F(MontgomeryFormalPowerSeriesTest, Operations) {
+  // Sizes on both sides of the naive threshold of `montgomery_convolution`.
+  for (const std::size_t n : {20, 1000}) {
+    auto a = quadratic<MontgomeryPowerSeries>(n);
+    auto b = quadratic(n);
+    check_content(canonical(a * a), b * b);
+    check_content(canonical(a + a.derivative()), b + b.derivative());
+    check_content(canonical(a - a.antiderivative()), b - b.antiderivative());
+    check_content(canonical(a.inverse(n)), b.inverse(n));
+    check_content(canonical(a.log(n)), b.log(n));
+    check_content(canonical(a.pow(12345, n)), b.pow(12345, n));
+    a[0] = 0, b[0] = 0;
+    check_content(canonical(a.exp(n)), b.exp(n));
+  }
+}
+
+class FastIOTest : public FormalPowerSeriesTest {
+protected:
+  std::FILE *file = std::tmpfile();
+
+  void TearDown() override { std::fclose(file); }
+
+  // Replaces the contents of `file` with its first `size` bytes.
+  void truncate_to(long size) {
+    std::rewind(file);
+    std::vector<unsigned char> bytes(static_cast<std::size_t>(size));
+    ASSERT_EQ(std::fread(bytes.data(), 1, bytes.size(), file), bytes.size());
+    std::fclose(file);
+    file = std::tmpfile();
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+  }
+};
+
+TEST_F(FastIOTest, IntegerRoundTrip) {
+  {
+    FastOutput output(file);
+    output.write(0), output.write(' ');
+    output.write(-42), output.write('\n');
+    output.write(std::numeric_limits<std::int64_t>::min()), output.write(' ');
+    output.write(std::numeric_limits<std::int64_t>::max()), output.write(' ');
+    output.write(std::numeric_limits<std::uint64_t>::max());
+  }
+  std::rewind(file);
+  FastInput input(file);
+  EXPECT_EQ(input.read<int>(), 0);
+  EXPECT_EQ(input.read<int>(), -42);
+  EXPECT_EQ(input.read<std::int64_t>(),
+            std::numeric_limits<std::int64_t>::min());
+  EXPECT_EQ(input.read<std::int64_t>(),
+            std::numeric_limits<std::int64_t>::max());
+  EXPECT_EQ(input.read<std::uint64_t>(),
+            std::numeric_limits<std::uint64_t>::max());
+  EXPECT_EQ(input.read<int>(), 0);
+}
+
+TEST_F(FastIOTest, BeyondBufferSize) {
+  // About 12 bytes per value, so the text spans several 64 KiB buffers and
+  // some values straddle a buffer boundary.
+  std::vector<std::int64_t> values(30000);
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    values[i] = (i % 2 ? -1 : 1) * static_cast<std::int64_t>(i * 123456789);
+  }
+  {
+    FastOutput output(file);
+    for (const auto value : values) {
+      output.write(value), output.write(' ');
+    }
+  }
+  EXPECT_GT(std::ftell(file), 1 << 17);
+  std::rewind(file);
+  FastInput input(file);
+  for (const auto value : values) {
+    ASSERT_EQ(input.read<std::int64_t>(), value);
+  }
+}
+
+TEST_F(FastIOTest, BinaryRoundTrip) {
+  // More coefficients than fit in one chunk or one 64 KiB block.
+  // Values near the modulus, from i^2 - 1.
+  const auto p = quadratic(100000, -1);
+  ASSERT_TRUE(write_binary(file, p));
+  ASSERT_TRUE(write_binary(file, PowerSeries()));
+  std::rewind(file);
+  const auto q = read_binary<PowerSeries>(file);
+  ASSERT_TRUE(q.has_value());
+  check_content(*q, p);
+  const auto empty = read_binary<PowerSeries>(file);
+  ASSERT_TRUE(empty.has_value());
+  EXPECT_TRUE(empty->empty());
+  EXPECT_FALSE(read_binary<PowerSeries>(file).has_value());
+}
+
+TEST_F(FastIOTest, TruncatedBinary) {
+  ASSERT_TRUE(write_binary(file, PowerSeries(20000, mint(7))));
+  truncate_to(std::ftell(file) - 1);
+  std::rewind(file);
+  EXPECT_FALSE(read_binary<PowerSeries>(file).has_value());
+  truncate_to(10);
+  std::rewind(file);
+  EXPECT_FALSE(read_binary<PowerSeries>(file).has_value());
+}
+
+TEST_F(FastIOTest, ReaderBeyondTwoGiB) {
+  // A sparse file whose one stored coefficient lies 3 GiB past the header.
+  constexpr std::uint64_t offset = std::uint64_t{3} << 28;
+  ASSERT_TRUE(fast_io_detail::write_header<mint>(file, offset + 1));
+  if (!fast_io_detail::seek(file, 16 + 4 * offset)) {
+    GTEST_SKIP() << "no 64-bit file offsets";
+  }
+  std::fwrite("\x2a\0\0\0", 1, 4, file);
+  std::rewind(file);
+  const auto reader = BinarySeriesReader<mint>::open(file);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(reader->size(), offset + 1);
+  const auto values = reader->read(offset, 1);
+  ASSERT_EQ(values.size(), 1u);
+  EXPECT_EQ(values[0], mint(42));
+  EXPECT_EQ(reader->read(0, 1), std::vector<mint>{0});
+  // Offsets whose byte position overflows are a failed read, not a wrap.
+  EXPECT_TRUE(reader->read(std::uint64_t{1} << 62, 1).empty());
+}
+
+TEST_F(FastIOTest, MismatchedModulus) {
+  ASSERT_TRUE(write_binary(file, PowerSeries{1, 2, 3}));
+  std::rewind(file);
+  EXPECT_FALSE(
+      read_binary<std::vector<atcoder::modint1000000007>>(file).has_value());
+}
+
+TEST_F(FastIOTest, CorruptLength) {
+  // A header claiming 2^60 coefficients, followed by only three.
+  ASSERT_TRUE(write_binary(file, PowerSeries{1, 2, 3}));
+  std::fseek(file, 8 + 7, SEEK_SET);
+  std::fputc(0x10, file);
+  std::rewind(file);
+  EXPECT_FALSE(read_binary<PowerSeries>(file).has_value());
+}